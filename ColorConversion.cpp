@@ -0,0 +1,331 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ColorConversion.cpp
+ *
+ * The following implements RGB24 to luma conversion with runtime selected SSSE3
+ * and AVX2 versions.
+ * 
+ * The vector versions compute the same expression as the scalar one, in the same
+ * order and without fused multiply-adds, so all of them agree bit for bit.
+ *
+ ****************************************************************************
+ */
+
+#include "ColorConversion.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define COLOR_CONVERSION_X86
+    #include <immintrin.h>
+#endif
+
+static inline float luma(const uint8_t* pixel) {
+    return kLumaRed * pixel[0] + kLumaGreen * pixel[1] + kLumaBlue * pixel[2];
+}
+
+static inline uint8_t saturate(const float value) {
+    return static_cast<uint8_t>(std::min(std::max(std::lrint(value), 0L), 255L));
+}
+
+static void rgbToLumaRowScalar(const uint8_t* rgb, const size_t width, float* out) {
+    for (size_t j = 0; j < width; ++j) {
+        out[j] = luma(rgb + 3 * j);
+    }
+}
+
+static void rgbToLumaRowScalar(const uint8_t* rgb, const size_t width, uint8_t* out) {
+    for (size_t j = 0; j < width; ++j) {
+        out[j] = saturate(luma(rgb + 3 * j));
+    }
+}
+
+#ifdef COLOR_CONVERSION_X86
+
+/*
+ * pshufb mask that gathers channel c of the pixels in the source block (0, 1 or 2, 16 bytes each) of 48
+ * packed bytes into their place among 16 output bytes; every other output byte is zeroed.
+ */
+__attribute__((target("ssse3")))
+static __m128i deinterleaveMask(const int channel, const int block) {
+    alignas(16) int8_t mask[16];
+
+    for (int k = 0; k < 16; ++k) {
+        const int source = 3 * k + channel - 16 * block;
+        mask[k] = (source >= 0 && source < 16) ? static_cast<int8_t>(source) : static_cast<int8_t>(0x80);
+    }
+
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+}
+
+struct DeinterleaveMasks {
+    __m128i m[3][3];    // [channel][block]
+};
+
+__attribute__((target("ssse3")))
+static DeinterleaveMasks deinterleaveMasks() {
+    DeinterleaveMasks masks;
+
+    for (int c = 0; c < 3; ++c) {
+        for (int b = 0; b < 3; ++b) {
+            masks.m[c][b] = deinterleaveMask(c, b);
+        }
+    }
+
+    return masks;
+}
+
+__attribute__((target("ssse3")))
+static inline __m128i deinterleave(const __m128i v0, const __m128i v1, const __m128i v2, const __m128i* masks) {
+    return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, masks[0]), _mm_shuffle_epi8(v1, masks[1])), _mm_shuffle_epi8(v2, masks[2]));
+}
+
+/*
+ * Deinterleaves 16 pixels and computes their luma as four vectors of four floats.
+ */
+__attribute__((target("ssse3")))
+static inline void luma16Ssse3(const uint8_t* rgb, const DeinterleaveMasks& masks, __m128 out[4]) {
+    const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb));
+    const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + 16));
+    const __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + 32));
+
+    const __m128i r = deinterleave(v0, v1, v2, masks.m[0]);
+    const __m128i g = deinterleave(v0, v1, v2, masks.m[1]);
+    const __m128i b = deinterleave(v0, v1, v2, masks.m[2]);
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 wr = _mm_set1_ps(kLumaRed);
+    const __m128 wg = _mm_set1_ps(kLumaGreen);
+    const __m128 wb = _mm_set1_ps(kLumaBlue);
+
+    const __m128i r16[2] = { _mm_unpacklo_epi8(r, zero), _mm_unpackhi_epi8(r, zero) };
+    const __m128i g16[2] = { _mm_unpacklo_epi8(g, zero), _mm_unpackhi_epi8(g, zero) };
+    const __m128i b16[2] = { _mm_unpacklo_epi8(b, zero), _mm_unpackhi_epi8(b, zero) };
+
+    for (int h = 0; h < 2; ++h) {
+        for (int q = 0; q < 2; ++q) {
+            const __m128 rf = _mm_cvtepi32_ps(q ? _mm_unpackhi_epi16(r16[h], zero) : _mm_unpacklo_epi16(r16[h], zero));
+            const __m128 gf = _mm_cvtepi32_ps(q ? _mm_unpackhi_epi16(g16[h], zero) : _mm_unpacklo_epi16(g16[h], zero));
+            const __m128 bf = _mm_cvtepi32_ps(q ? _mm_unpackhi_epi16(b16[h], zero) : _mm_unpacklo_epi16(b16[h], zero));
+
+            out[2 * h + q] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wr, rf), _mm_mul_ps(wg, gf)), _mm_mul_ps(wb, bf));
+        }
+    }
+}
+
+__attribute__((target("ssse3")))
+static void rgbToLumaRowSsse3(const uint8_t* rgb, const size_t width, float* out) {
+    const DeinterleaveMasks masks = deinterleaveMasks();
+
+    size_t j = 0;
+
+    for (; j + 16 <= width; j += 16) {
+        __m128 values[4];
+        luma16Ssse3(rgb + 3 * j, masks, values);
+
+        for (int q = 0; q < 4; ++q) {
+            _mm_storeu_ps(out + j + 4 * q, values[q]);
+        }
+    }
+
+    rgbToLumaRowScalar(rgb + 3 * j, width - j, out + j);
+}
+
+__attribute__((target("ssse3")))
+static void rgbToLumaRowSsse3(const uint8_t* rgb, const size_t width, uint8_t* out) {
+    const DeinterleaveMasks masks = deinterleaveMasks();
+
+    size_t j = 0;
+
+    for (; j + 16 <= width; j += 16) {
+        __m128 values[4];
+        luma16Ssse3(rgb + 3 * j, masks, values);
+
+        const __m128i lo = _mm_packs_epi32(_mm_cvtps_epi32(values[0]), _mm_cvtps_epi32(values[1]));
+        const __m128i hi = _mm_packs_epi32(_mm_cvtps_epi32(values[2]), _mm_cvtps_epi32(values[3]));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + j), _mm_packus_epi16(lo, hi));
+    }
+
+    rgbToLumaRowScalar(rgb + 3 * j, width - j, out + j);
+}
+
+/*
+ * Deinterleaves 32 pixels, 16 per 128 bit lane, and computes their luma as four vectors of eight floats in
+ * pixel order.
+ */
+__attribute__((target("avx2")))
+static inline void luma32Avx2(const uint8_t* rgb, const __m256i masks[3][3], __m256 out[4]) {
+    __m256i v[3];
+
+    for (int k = 0; k < 3; ++k) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + 16 * k));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + 48 + 16 * k));
+
+        v[k] = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    }
+
+    __m256i channels[3];
+
+    for (int c = 0; c < 3; ++c) {
+        channels[c] = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(v[0], masks[c][0]), _mm256_shuffle_epi8(v[1], masks[c][1])),
+                                      _mm256_shuffle_epi8(v[2], masks[c][2]));
+    }
+
+    const __m256 wr = _mm256_set1_ps(kLumaRed);
+    const __m256 wg = _mm256_set1_ps(kLumaGreen);
+    const __m256 wb = _mm256_set1_ps(kLumaBlue);
+
+    for (int q = 0; q < 4; ++q) {
+        __m256 f[3];
+
+        for (int c = 0; c < 3; ++c) {
+            const __m128i lane = (q < 2) ? _mm256_castsi256_si128(channels[c]) : _mm256_extracti128_si256(channels[c], 1);
+            const __m128i bytes = (q % 2 == 0) ? lane : _mm_srli_si128(lane, 8);
+
+            f[c] = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+        }
+
+        out[q] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(wr, f[0]), _mm256_mul_ps(wg, f[1])), _mm256_mul_ps(wb, f[2]));
+    }
+}
+
+__attribute__((target("avx2")))
+static void broadcastMasks(__m256i masks[3][3]) {
+    const DeinterleaveMasks masks128 = deinterleaveMasks();
+
+    for (int c = 0; c < 3; ++c) {
+        for (int b = 0; b < 3; ++b) {
+            masks[c][b] = _mm256_broadcastsi128_si256(masks128.m[c][b]);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void rgbToLumaRowAvx2(const uint8_t* rgb, const size_t width, float* out) {
+    __m256i masks[3][3];
+    broadcastMasks(masks);
+
+    size_t j = 0;
+
+    for (; j + 32 <= width; j += 32) {
+        __m256 values[4];
+        luma32Avx2(rgb + 3 * j, masks, values);
+
+        for (int q = 0; q < 4; ++q) {
+            _mm256_storeu_ps(out + j + 8 * q, values[q]);
+        }
+    }
+
+    rgbToLumaRowScalar(rgb + 3 * j, width - j, out + j);
+}
+
+__attribute__((target("avx2")))
+static void rgbToLumaRowAvx2(const uint8_t* rgb, const size_t width, uint8_t* out) {
+    __m256i masks[3][3];
+    broadcastMasks(masks);
+
+    size_t j = 0;
+
+    for (; j + 32 <= width; j += 32) {
+        __m256 values[4];
+        luma32Avx2(rgb + 3 * j, masks, values);
+
+        // The packs work per lane, the 64 bit permutes put the pixels back in order.
+        const __m256i lo = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_cvtps_epi32(values[0]), _mm256_cvtps_epi32(values[1])), 0xD8);
+        const __m256i hi = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_cvtps_epi32(values[2]), _mm256_cvtps_epi32(values[3])), 0xD8);
+        const __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j), bytes);
+    }
+
+    rgbToLumaRowScalar(rgb + 3 * j, width - j, out + j);
+}
+
+#endif
+
+SimdLevel detectSimdLevel() {
+#ifdef COLOR_CONVERSION_X86
+    static const SimdLevel level = __builtin_cpu_supports("avx2") ? kSimdAvx2 :
+                                   __builtin_cpu_supports("ssse3") ? kSimdSsse3 : kSimdScalar;
+    return level;
+#else
+    return kSimdScalar;
+#endif
+}
+
+const char* simdLevelName(const SimdLevel level) {
+    switch (level) {
+        case kSimdAvx2:     return "AVX2";
+        case kSimdSsse3:    return "SSSE3";
+        default:            return "scalar";
+    }
+}
+
+template <typename T>
+static void dispatch(const uint8_t* rgb, const size_t width, T* luma, const SimdLevel requested) {
+    const SimdLevel level = std::min(requested, detectSimdLevel());
+
+#ifdef COLOR_CONVERSION_X86
+    if (level == kSimdAvx2) {
+        rgbToLumaRowAvx2(rgb, width, luma);
+        return;
+    }
+
+    if (level == kSimdSsse3) {
+        rgbToLumaRowSsse3(rgb, width, luma);
+        return;
+    }
+#endif
+
+    rgbToLumaRowScalar(rgb, width, luma);
+}
+
+void rgbToLumaRow(const uint8_t* rgb, const size_t width, float* luma, const SimdLevel level) {
+    dispatch(rgb, width, luma, level);
+}
+
+void rgbToLumaRow(const uint8_t* rgb, const size_t width, uint8_t* luma, const SimdLevel level) {
+    dispatch(rgb, width, luma, level);
+}
+
+void rgbToLumaRow(const uint8_t* rgb, const size_t width, float* luma) {
+    dispatch(rgb, width, luma, detectSimdLevel());
+}
+
+void rgbToLumaRow(const uint8_t* rgb, const size_t width, uint8_t* luma) {
+    dispatch(rgb, width, luma, detectSimdLevel());
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ColorConversion.hpp
+ *
+ * The following implements RGB24 to luma conversion, one row at a time, with
+ * SSSE3 and AVX2 versions that deinterleave the packed pixels with byte shuffles.
+ * The fastest version the CPU supports is picked at runtime; the scalar version
+ * is the reference and the fallback on other architectures.
+ *
+ ****************************************************************************
+ */
+
+#ifndef COLOR_CONVERSION_HPP
+#define COLOR_CONVERSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+const float kLumaRed    = 0.2126f;
+const float kLumaGreen  = 0.7512f;
+const float kLumaBlue   = 0.0722f;
+
+enum SimdLevel {
+    kSimdScalar,
+    kSimdSsse3,
+    kSimdAvx2
+};
+
+// The best level this CPU supports, detected once.
+SimdLevel detectSimdLevel();
+const char* simdLevelName(const SimdLevel level);
+
+// Convert width packed RGB pixels to luma with the given implementation. uint8 output is rounded and
+// saturated. Asking for a level the CPU does not support falls back to the best one it does.
+void rgbToLumaRow(const uint8_t* rgb, const size_t width, float* luma, const SimdLevel level);
+void rgbToLumaRow(const uint8_t* rgb, const size_t width, uint8_t* luma, const SimdLevel level);
+
+// Same, with the detected level.
+void rgbToLumaRow(const uint8_t* rgb, const size_t width, float* luma);
+void rgbToLumaRow(const uint8_t* rgb, const size_t width, uint8_t* luma);
+
+#endif
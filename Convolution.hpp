@@ -0,0 +1,337 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Convolution.hpp
+ *
+ * The following implements convolution with fixed-size kernels. The kernel size
+ * is a template parameter, so the loops over the kernel unroll and no temporaries
+ * are allocated per pixel, and the border handling is selectable.
+ *
+ ****************************************************************************
+ */
+
+#ifndef CONVOLUTION_HPP
+#define CONVOLUTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "Image.hpp"
+#include "Kernels.hpp"
+#include "Parallel.hpp"
+
+/*
+ * How pixels outside the image are treated. Skip leaves the output zero wherever the kernel would reach
+ * outside the image; zero pads with zeros; replicate repeats the edge pixel; reflect mirrors about the
+ * edge pixel without repeating it (-1 reads 1).
+ */
+enum BorderMode {
+    kBorderSkip,
+    kBorderZero,
+    kBorderReplicate,
+    kBorderReflect
+};
+
+// Rows handed to a thread at a time by the convolutions.
+const size_t kConvolutionChunkRows = 64;
+
+/*
+ * Maps index onto [0, n) for the given border mode. Returns -1 when the pixel reads as zero.
+ */
+inline ptrdiff_t borderIndex(ptrdiff_t index, const ptrdiff_t n, const BorderMode border) {
+    if (index >= 0 && index < n) {
+        return index;
+    }
+
+    switch (border) {
+        case kBorderReplicate:
+            return index < 0 ? 0 : n - 1;
+
+        case kBorderReflect:
+            if (n == 1) {
+                return 0;
+            }
+
+            while (index < 0 || index >= n) {
+                index = index < 0 ? -index : 2 * (n - 1) - index;
+            }
+
+            return index;
+
+        default:
+            return -1;
+    }
+}
+
+/*
+ * Fills the radius values on either side of padded[radius, radius + width), which already holds a row, as
+ * the border mode says.
+ */
+inline void padRow(float* padded, const size_t width, const int radius, const BorderMode border) {
+    for (int b = 1; b <= radius; ++b) {
+        const ptrdiff_t left  = borderIndex(-b, width, border);
+        const ptrdiff_t right = borderIndex(width - 1 + b, width, border);
+
+        padded[radius - b]             = left < 0 ? 0.0f : padded[radius + left];
+        padded[radius + width - 1 + b] = right < 0 ? 0.0f : padded[radius + right];
+    }
+}
+
+/*
+ * Copies I into an image with top, bottom, left and right extra rows and columns, filled as the border mode
+ * says (zeros for skip). The runtime sized convolutions read from this copy so their inner loops need no
+ * edge checks.
+ */
+inline GrayImage padImage(const GrayImage& I, const size_t top, const size_t bottom, const size_t left, const size_t right,
+                          const BorderMode border) {
+    const ptrdiff_t rows = I.height();
+    const ptrdiff_t cols = I.width();
+
+    GrayImage P(cols + left + right, rows + top + bottom);
+
+    for (size_t i = 0; i < P.height(); ++i) {
+        const ptrdiff_t y = borderIndex(static_cast<ptrdiff_t>(i) - static_cast<ptrdiff_t>(top), rows, border);
+
+        if (y < 0) {
+            continue;
+        }
+
+        const float* src = I.row(y);
+        float* dst = P.row(i);
+
+        for (size_t j = 0; j < P.width(); ++j) {
+            const ptrdiff_t x = borderIndex(static_cast<ptrdiff_t>(j) - static_cast<ptrdiff_t>(left), cols, border);
+            dst[j] = x < 0 ? 0.0f : src[x];
+        }
+    }
+
+    return P;
+}
+
+/*
+ * Zeroes the output pixels whose kernel reached outside the image, which is what kBorderSkip asks for.
+ */
+inline void clearBorder(GrayImage* O, const size_t top, const size_t bottom, const size_t left, const size_t right) {
+    const size_t rows = O->height();
+    const size_t cols = O->width();
+
+    for (size_t i = 0; i < rows; ++i) {
+        float* row = O->row(i);
+
+        if (i < top || i + bottom >= rows) {
+            std::fill(row, row + cols, 0.0f);
+        }
+        else {
+            std::fill(row, row + std::min(left, cols), 0.0f);
+            std::fill(row + cols - std::min(right, cols), row + cols, 0.0f);
+        }
+    }
+}
+
+/*
+ * Correlates one output row with a separable kernel. rows holds the K source rows centred on the output
+ * row, already mapped through the border mode (point absent rows at zeros), and padded is scratch space for
+ * width + K - 1 values. Both the in-memory and the streamed edge maps go through here.
+ */
+template <int K>
+void correlateRow(const float* const* rows, const size_t width, const SeparableKernel<K>& kernel, const BorderMode border,
+                  float* padded, float* out) {
+    const int radius = K / 2;
+
+    float column[K];
+    float row[K];
+
+    for (int k = 0; k < K; ++k) {
+        column[k] = kernel.column(k);
+        row[k] = kernel.row(k);
+    }
+
+    for (size_t j = 0; j < width; ++j) {
+        float sum = 0.0f;
+
+        for (int a = 0; a < K; ++a) {
+            sum += column[a] * rows[a][j];
+        }
+
+        padded[radius + j] = sum;
+    }
+
+    padRow(padded, width, radius, border);
+
+    for (size_t j = 0; j < width; ++j) {
+        float sum = 0.0f;
+
+        for (int b = 0; b < K; ++b) {
+            sum += row[b] * padded[j + b];
+        }
+
+        out[j] = sum;
+    }
+
+    if (border == kBorderSkip) {
+        std::fill(out, out + std::min<size_t>(radius, width), 0.0f);
+        std::fill(out + width - std::min<size_t>(radius, width), out + width, 0.0f);
+    }
+}
+
+/*
+ * Correlates I with a K x K kernel centred on each output pixel. The kernel is applied as it is, without
+ * normalization; the smoothing kernels in Kernels.hpp already sum to one.
+ */
+template <int K>
+GrayImage conv2d(const GrayImage& I, const Kernel<K>& kernel, const BorderMode border = kBorderReplicate) {
+    static_assert(K % 2 == 1, "kernels are centred on the output pixel, K must be odd");
+
+    const int radius = K / 2;
+    const size_t rows = I.height();
+    const size_t cols = I.width();
+
+    GrayImage O(cols, rows);
+
+    if (border == kBorderSkip && (rows <= 2 * static_cast<size_t>(radius) || cols <= 2 * static_cast<size_t>(radius))) {
+        return O;
+    }
+
+    const size_t rowBegin       = (border == kBorderSkip) ? radius : 0;
+    const size_t rowEnd         = (border == kBorderSkip) ? rows - radius : rows;
+    const size_t paddedWidth    = cols + K - 1;
+
+    float weights[K][K];
+
+    for (int a = 0; a < K; ++a) {
+        for (int b = 0; b < K; ++b) {
+            weights[a][b] = kernel(a, b);
+        }
+    }
+
+    parallelFor(rowBegin, rowEnd, [&](const size_t chunkBegin, const size_t chunkEnd, const size_t) {
+        // Padded copies of the K source rows around the output row, in a ring indexed by source row.
+        std::vector<float> window(K * paddedWidth);
+
+        const auto slot = [&](const ptrdiff_t sourceRow) {
+            return &window[((sourceRow % K + K) % K) * paddedWidth];
+        };
+
+        const auto load = [&](const ptrdiff_t sourceRow) {
+            float* padded = slot(sourceRow);
+            const ptrdiff_t mapped = borderIndex(sourceRow, rows, border);
+
+            if (mapped < 0) {
+                std::fill(padded, padded + paddedWidth, 0.0f);
+                return;
+            }
+
+            std::copy(I.row(mapped), I.row(mapped) + cols, padded + radius);
+            padRow(padded, cols, radius, border);
+        };
+
+        for (int a = 0; a < K - 1; ++a) {
+            load(static_cast<ptrdiff_t>(chunkBegin) + a - radius);
+        }
+
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            load(static_cast<ptrdiff_t>(i) + radius);
+
+            const float* src[K];
+
+            for (int a = 0; a < K; ++a) {
+                src[a] = slot(static_cast<ptrdiff_t>(i) + a - radius);
+            }
+
+            float* dst = O.row(i);
+
+            for (size_t j = 0; j < cols; ++j) {
+                float sum = 0.0f;
+
+                for (int a = 0; a < K; ++a) {
+                    for (int b = 0; b < K; ++b) {
+                        sum += weights[a][b] * src[a][j + b];
+                    }
+                }
+
+                dst[j] = sum;
+            }
+
+            if (border == kBorderSkip) {
+                std::fill(dst, dst + radius, 0.0f);
+                std::fill(dst + cols - radius, dst + cols, 0.0f);
+            }
+        }
+    }, kConvolutionChunkRows);
+
+    return O;
+}
+
+/*
+ * Same as above for a separable kernel: a vertical pass with the column weights, then a horizontal pass with
+ * the row weights, one output row at a time.
+ */
+template <int K>
+GrayImage conv2d(const GrayImage& I, const SeparableKernel<K>& kernel, const BorderMode border = kBorderReplicate) {
+    static_assert(K % 2 == 1, "kernels are centred on the output pixel, K must be odd");
+
+    const int radius = K / 2;
+    const size_t rows = I.height();
+    const size_t cols = I.width();
+
+    GrayImage O(cols, rows);
+
+    if (border == kBorderSkip && (rows <= 2 * static_cast<size_t>(radius) || cols <= 2 * static_cast<size_t>(radius))) {
+        return O;
+    }
+
+    const size_t rowBegin = (border == kBorderSkip) ? radius : 0;
+    const size_t rowEnd   = (border == kBorderSkip) ? rows - radius : rows;
+
+    parallelFor(rowBegin, rowEnd, [&](const size_t chunkBegin, const size_t chunkEnd, const size_t) {
+        std::vector<float> padded(cols + K - 1);
+        std::vector<float> zeros(cols, 0.0f);
+
+        for (size_t i = chunkBegin; i < chunkEnd; ++i) {
+            const float* src[K];
+
+            for (int a = 0; a < K; ++a) {
+                const ptrdiff_t mapped = borderIndex(static_cast<ptrdiff_t>(i) + a - radius, rows, border);
+                src[a] = mapped < 0 ? zeros.data() : I.row(mapped);
+            }
+
+            correlateRow(src, cols, kernel, border, padded.data(), O.row(i));
+        }
+    }, kConvolutionChunkRows);
+
+    return O;
+}
+
+#endif
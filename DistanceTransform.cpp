@@ -0,0 +1,193 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: DistanceTransform.cpp
+ *
+ * The following implements an exact Euclidean distance transform of a thresholded
+ * edge map in linear time (Felzenszwalb & Huttenlocher).
+ *
+ ****************************************************************************
+ */
+
+#include "DistanceTransform.hpp"
+#include "Parallel.hpp"
+
+#include <limits>
+#include <vector>
+
+const size_t kMinChunkColumns   = 64;
+const size_t kMinChunkRows      = 16;
+
+/*
+ * Lower envelope of the parabolas rooted at every finite sample of f. Writes the squared distance to d and
+ * the root of the winning parabola to arg (-1 where f has no finite sample). v and z are scratch space of
+ * n and n + 1 entries.
+ */
+static void distanceTransform1d(const float* f, const size_t n, float* d, int32_t* arg, int32_t* v, double* z) {
+    const double kInfinity = std::numeric_limits<double>::infinity();
+
+    int k = -1;
+
+    for (size_t q = 0; q < n; ++q) {
+        if (std::isinf(f[q])) {
+            continue;
+        }
+
+        if (k < 0) {
+            k = 0;
+            v[0] = q;
+            z[0] = -kInfinity;
+            z[1] = kInfinity;
+            continue;
+        }
+
+        const double fq = f[q] + static_cast<double>(q) * q;
+        double s;
+
+        while (true) {
+            const double p = v[k];
+            s = (fq - (f[v[k]] + p * p)) / (2.0 * q - 2.0 * p);
+
+            if (s > z[k]) {
+                break;
+            }
+
+            --k;
+        }
+
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = kInfinity;
+    }
+
+    if (k < 0) {
+        for (size_t q = 0; q < n; ++q) {
+            d[q] = std::numeric_limits<float>::infinity();
+            arg[q] = -1;
+        }
+
+        return;
+    }
+
+    k = 0;
+
+    for (size_t q = 0; q < n; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+
+        const float dq = static_cast<float>(q) - static_cast<float>(v[k]);
+
+        d[q] = dq * dq + f[v[k]];
+        arg[q] = v[k];
+    }
+}
+
+void distanceTransform(const GrayImage& edgeMap, const float threshold, GrayImage* distance, IndexImage* nearest) {
+    const size_t width  = edgeMap.width();
+    const size_t height = edgeMap.height();
+
+    distance->resize(width, height);
+
+    if (nearest) {
+        nearest->resize(width, height);
+    }
+
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    // Column pass. On a binary image the 1D transform of a column is just the distance to the closest edge
+    // pixel above or below, so it is done with a downward and an upward sweep over whole rows; every thread
+    // owns a strip of columns and reads memory in storage order.
+    IndexImage nearestRow(width, height);
+
+    parallelFor(0, width, [&](const size_t colBegin, const size_t colEnd, const size_t) {
+        for (size_t i = 0; i < height; ++i) {
+            const float* edges = edgeMap.row(i);
+            const int32_t* above = (i > 0) ? nearestRow.row(i - 1) : NULL;
+            int32_t* current = nearestRow.row(i);
+
+            for (size_t j = colBegin; j < colEnd; ++j) {
+                current[j] = (edges[j] >= threshold) ? static_cast<int32_t>(i) : (above ? above[j] : -1);
+            }
+        }
+
+        for (size_t i = height - 1; i-- > 0; ) {
+            const int32_t* below = nearestRow.row(i + 1);
+            int32_t* current = nearestRow.row(i);
+
+            for (size_t j = colBegin; j < colEnd; ++j) {
+                if (below[j] >= 0 && (current[j] < 0 || below[j] - static_cast<int32_t>(i) < static_cast<int32_t>(i) - current[j])) {
+                    current[j] = below[j];
+                }
+            }
+        }
+    }, kMinChunkColumns);
+
+    // Row pass, the lower envelope of the column distances.
+    parallelFor(0, height, [&](const size_t rowBegin, const size_t rowEnd, const size_t) {
+        std::vector<float>      f(width);
+        std::vector<float>      d(width);
+        std::vector<int32_t>    arg(width);
+        std::vector<int32_t>    v(width);
+        std::vector<double>     z(width + 1);
+
+        for (size_t i = rowBegin; i < rowEnd; ++i) {
+            const int32_t* rows = nearestRow.row(i);
+
+            for (size_t j = 0; j < width; ++j) {
+                const float dy = static_cast<float>(rows[j]) - static_cast<float>(i);
+                f[j] = (rows[j] >= 0) ? dy * dy : std::numeric_limits<float>::infinity();
+            }
+
+            distanceTransform1d(f.data(), width, d.data(), arg.data(), v.data(), z.data());
+
+            float* out = distance->row(i);
+
+            for (size_t j = 0; j < width; ++j) {
+                out[j] = std::sqrt(d[j]);
+            }
+
+            if (nearest) {
+                int32_t* index = nearest->row(i);
+
+                for (size_t j = 0; j < width; ++j) {
+                    index[j] = (arg[j] >= 0) ? rows[arg[j]] * static_cast<int32_t>(width) + arg[j] : -1;
+                }
+            }
+        }
+    }, kMinChunkRows);
+}
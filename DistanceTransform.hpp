@@ -0,0 +1,81 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: DistanceTransform.hpp
+ *
+ * The following implements an exact Euclidean distance transform of a thresholded
+ * edge map in linear time (Felzenszwalb & Huttenlocher, "Distance Transforms of
+ * Sampled Functions"), optionally with the index of the nearest edge pixel.
+ *
+ ****************************************************************************
+ */
+
+#ifndef DISTANCE_TRANSFORM_HPP
+#define DISTANCE_TRANSFORM_HPP
+
+#include <cmath>
+#include <cstdint>
+
+#include "Image.hpp"
+
+typedef Image<int32_t, 1> IndexImage;
+
+// Edge map values at or above this percentile count as edges for the distance transform.
+const float kEdgeThresholdPercentile = 90.0f;
+
+/*
+ * Writes into distance the Euclidean distance (in pixels) from every pixel to the closest pixel whose edge
+ * value is at least threshold. If nearest is given it receives the linear index (y * width + x) of that
+ * edge pixel. Without any edge pixel all distances are infinite and all indices -1.
+ */
+void distanceTransform(const GrayImage& edgeMap, const float threshold, GrayImage* distance, IndexImage* nearest = NULL);
+
+/*
+ * External force at (x, y) from the nearest edge map: the vector pointing at the closest edge pixel.
+ * Returns false when there is no edge at all.
+ */
+inline bool nearestEdgeForce(const IndexImage& nearest, const size_t x, const size_t y, float* fx, float* fy) {
+    const int32_t index = nearest(y, x);
+
+    if (index < 0) {
+        return false;
+    }
+
+    *fx = static_cast<float>(index % static_cast<int32_t>(nearest.width())) - static_cast<float>(x);
+    *fy = static_cast<float>(index / static_cast<int32_t>(nearest.width())) - static_cast<float>(y);
+
+    return true;
+}
+
+#endif
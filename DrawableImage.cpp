@@ -43,12 +43,85 @@
  */
 
 #include "DrawableImage.hpp"
+#include "ScanlineReader.hpp"
+
+/*
+ * Runs the processing chain on the raw image: gray conversion, edge map, statistics and the display keys.
+ * Touches no GL or object state, so it is safe on a worker thread.
+ */
+static ProcessedData computeProcessedData(const RgbImage& rawImage) {
+    ProcessedData data;
+    Timer timer;
+
+    data.ok = true;
+
+    const GrayImage gray = rgbToGray(rawImage);
+    timer.tick();
+    data.edgeMap.reset(new GrayImage(computeEdgeMap(gray)));
+
+    std::cout << "DrawableImage::computeProcessedData(): edge map time: " << timer.tock() << " ms." << std::endl;
+
+    timer.tick();
+    data.stats = computeImageStats(*data.edgeMap, &data.keys);
+
+    std::cout << "DrawableImage::computeProcessedData(): statistics time: " << timer.tock() << " ms." << std::endl;
+
+    return data;
+}
+
+// Prefetch entry points. The pixels are taken by value so the worker frees them as soon as it is done.
+static ProcessedData processPixels(RgbImage rawImage) {
+    return computeProcessedData(rawImage);
+}
+
+/*
+ * The worker decodes through the scanline reader, which reports failure instead of showing UI, and only if
+ * the file is still the one that was opened at the size it was opened at. Anything else comes back with ok
+ * unset and the caller decodes on its own thread.
+ */
+static ProcessedData processFile(const std::string fileName, const std::string stamp, const size_t width, const size_t height) {
+    ProcessedData failed;
+    failed.ok = false;
+
+    ImageHeader header;
+
+    if (fileStamp(fileName) != stamp || !readImageHeader(fileName, &header)) {
+        return failed;
+    }
+
+    // The viewer holds the whole image anyway, so an interlaced PNG may as well be buffered whole.
+    std::unique_ptr<ScanlineReader> reader(openScanlineReader(fileName, 1, header.interlaced));
+
+    if (!reader || reader->width() != width || reader->height() != height) {
+        return failed;
+    }
+
+    RgbImage rawImage(width, height);
+    RgbImage strip(width, kPrefetchStripRows);
+
+    for (size_t row = 0; row < height; ) {
+        const size_t count = reader->readRows(&strip, std::min(kPrefetchStripRows, height - row));
+
+        if (count == 0) {
+            std::cout << "DrawableImage::processFile(): " << fileName << ": decoding stopped at row " << row << "." << std::endl;
+            return failed;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            std::copy(strip.row(i), strip.row(i) + width * kBytesPerPixel, rawImage.row(row + i));
+        }
+
+        row += count;
+    }
+
+    return computeProcessedData(rawImage);
+}
 
 /*
  * This is a simple class built on top of OpenGL that manages drawing images in a higher-level and quicker way.
  */
 
-DrawableImage::DrawableImage(const char* fileName) {
+DrawableImage::DrawableImage(const char* fileName, const ProcessedChannel processedChannel) {
     m_xScale    = 1.0;
     m_yScale    = 1.0;
 
@@ -63,60 +136,346 @@ DrawableImage::DrawableImage(const char* fileName) {
     m_xFlip     = false;
     m_yFlip     = false;
 
-    Timer timer;
+    m_width     = 0;
+    m_height    = 0;
+
+    m_rawTextureId          = 0;
+    m_processedTextureId    = 0;
+
+    m_hasDisplayWindow      = false;
+    m_sourceLost            = false;
+    m_prefetchFailed        = false;
+
+    m_tileScale             = 1;
+    m_detailTextureId       = 0;
+    m_detailX               = 0;
+    m_detailY               = 0;
+    m_detailWidth           = 0;
+    m_detailHeight          = 0;
 
     if (fileName) {
-        m_rawImage = loadImage(fileName, &m_width, &m_height);
-        m_edgeMap = rgbToGray(m_rawImage, m_width, m_height);
+        m_fileName = fileName;
+        m_sourceStamp = fileStamp(m_fileName);
+
+        if (isTiledImage(m_fileName)) {
+            m_tiles.reset(new TiledImageReader());
+
+            if (m_tiles->open(m_fileName)) {
+                m_tileScale = m_tiles->overviewScale();
+            }
+            else {
+                m_tiles.reset();
+            }
+        }
+
+        Timer timer;
         timer.tick();
-        m_edgeMap = computeEdgeMap(m_edgeMap);
-        const double latency = timer.tock();
+        RgbImage rawImage = loadImage(m_fileName, &m_width, &m_height);
+        const double decodeLatency = timer.tock();
+
+        m_view.x        = 0.0f;
+        m_view.y        = 0.0f;
+        m_view.width    = m_width;
+        m_view.height   = m_height;
+
+        if (!rawImage.empty()) {
+            timer.tick();
+            uploadRawTexture(rawImage);
+            const double uploadLatency = timer.tock();
+
+            std::cout << "DrawableImage::DrawableImage(): decode time: " << decodeLatency << " ms, raw texture upload time: "
+                      << uploadLatency << " ms." << std::endl;
+
+            // The decoded pixels are dropped once the textures are up, or handed to the prefetch worker.
+            if (processedChannel == kProcessedEager) {
+                adoptProcessedData(computeProcessedData(rawImage));
+                uploadProcessedTexture();
+            }
+            else if (processedChannel == kProcessedPrefetch) {
+                m_pendingProcessed = std::async(std::launch::async, processPixels, std::move(rawImage));
+            }
+        }
+    }
+    else {
+        // TODO: gracefully handle the image not being loaded.
+    }
+
+    ResidencyManager::instance().add(this);
+}
+
+DrawableImage::~DrawableImage() {
+    ResidencyManager::instance().remove(this);
+    releaseTextures();
+
+    if (m_pendingProcessed.valid()) {
+        m_pendingProcessed.wait();
+    }
+}
+
+/*
+ * Decodes the source again for a rebuild. The file must still be the one that was opened: if it was changed
+ * or removed since, or no longer decodes to the same size, nothing is rebuilt from it. The image is marked
+ * lost and an empty image is returned; whatever is still resident keeps being shown.
+ */
+RgbImage DrawableImage::loadSource() {
+    RgbImage rawImage;
+
+    if (m_sourceLost) {
+        return rawImage;
+    }
 
-        std::cout << "DrawableImage::DrawableImage(): edge map time: " << latency << " ms." << std::endl;
+    size_t width = 0;
+    size_t height = 0;
 
-        m_processedImage = matToImage(m_edgeMap);
+    if (fileStamp(m_fileName) != m_sourceStamp) {
+        std::cout << "DrawableImage::loadSource(): " << m_fileName << " changed on disk since it was opened." << std::endl;
+    }
+    else if (!decodeImage(m_fileName, &rawImage, &width, &height)) {
+        std::cout << "DrawableImage::loadSource(): failed to decode " << m_fileName << "." << std::endl;
+    }
+    else if (width != m_width || height != m_height) {
+        std::cout << "DrawableImage::loadSource(): " << m_fileName << " decoded to " << width << " x " << height
+                  << ", expected " << m_width << " x " << m_height << "." << std::endl;
     }
     else {
-        // TODO: gracefully handle the image not being loaded.
+        return rawImage;
+    }
+
+    m_sourceLost = true;
+
+    return RgbImage();
+}
+
+bool DrawableImage::sourceLost() const {
+    return m_sourceLost;
+}
+
+/*
+ * Makes sure the processed data is in place and hands back the edge map. An edge map a tool still holds
+ * survives an eviction, so the statistics and keys are rebuilt from it without touching the source. Failing
+ * that, a prefetch still in flight is waited for; otherwise, or if the prefetch could not decode the source,
+ * the chain runs here on the source decoded again.
+ */
+std::shared_ptr<const GrayImage> DrawableImage::buildProcessedData() {
+    const std::shared_ptr<const GrayImage> edges = m_edgeMap.lock();
+
+    if (edges) {
+        Timer timer;
+        timer.tick();
+
+        ProcessedData data;
+        data.ok = true;
+        data.edgeMap = edges;
+        data.stats = computeImageStats(*edges, &data.keys);
+
+        std::cout << "DrawableImage::buildProcessedData(): rebuilt the statistics from the live edge map in " << timer.tock()
+                  << " ms." << std::endl;
+
+        return adoptProcessedData(std::move(data));
+    }
+
+    if (m_pendingProcessed.valid()) {
+        Timer timer;
+        timer.tick();
+        ProcessedData data = m_pendingProcessed.get();
+
+        std::cout << "DrawableImage::buildProcessedData(): waited " << timer.tock() << " ms for the prefetch." << std::endl;
+
+        if (data.ok) {
+            return adoptProcessedData(std::move(data));
+        }
+
+        m_prefetchFailed = true;
+
+        std::cout << "DrawableImage::buildProcessedData(): the prefetch could not decode the source, decoding it here." << std::endl;
     }
 
-    if (m_rawImage.size() > 0) {
-        // Generate a texture for the raw image data.
-        glGenTextures(1, &m_rawTextureId);
-        std::cout << "DrawableImage::DrawableImage(): generated texture id: " << m_rawTextureId << std::endl;
+    const RgbImage rawImage = loadSource();
 
-        glBindTexture(GL_TEXTURE_2D, m_rawTextureId);
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (rawImage.empty()) {
+        return std::shared_ptr<const GrayImage>();
+    }
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_width, m_height, 0, GL_RGB,  GL_UNSIGNED_BYTE, m_rawImage.data());
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // GL_LINEAR
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // GL_LINEAR
+    return adoptProcessedData(computeProcessedData(rawImage));
+}
 
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+/*
+ * Takes over the statistics and display keys. The edge map is handed back to the caller; nothing here keeps
+ * it alive. One a tool still holds is never replaced, so the image keeps finding and counting that one.
+ */
+std::shared_ptr<const GrayImage> DrawableImage::adoptProcessedData(ProcessedData data) {
+    std::shared_ptr<const GrayImage> edges = m_edgeMap.lock();
 
+    if (!edges) {
+        edges = data.edgeMap;
+        m_edgeMap = edges;
+    }
 
-        // Generate a texture for the processed image data.
-        glGenTextures(1, &m_processedTextureId);
-        std::cout << "DrawableImage::DrawableImage(): generated texture id: " << m_processedTextureId << std::endl;
+    m_edgeStats = std::move(data.stats);
+    m_edgeKeys.swap(data.keys);
 
-        glBindTexture(GL_TEXTURE_2D, m_processedTextureId);
-        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    // Keep the user's window when the data is being rebuilt after an eviction.
+    if (!m_hasDisplayWindow) {
+        m_displayWindow = fullRangeWindow(m_edgeStats);
+        m_hasDisplayWindow = true;
+    }
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_width, m_height, 0, GL_RGB,  GL_UNSIGNED_BYTE, m_processedImage.data());
-        //glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_width, m_height, 0, GL_R8,  GL_UNSIGNED_BYTE, m_processedImage.data());
+    std::cout << "DrawableImage::adoptProcessedData(): edge map min, max, mean: " << m_edgeStats.min << ", " << m_edgeStats.max
+              << ", " << m_edgeStats.mean << std::endl;
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // GL_LINEAR
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // GL_LINEAR
+    return edges;
+}
 
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+/*
+ * Starts building the processed data on a worker thread if it is neither built nor on its way, so a later
+ * switch to the processed view does not stall. The worker decodes its own copy of the source.
+ */
+void DrawableImage::prefetchProcessed() {
+    if (!m_edgeKeys.empty() || m_pendingProcessed.valid() || m_prefetchFailed || m_sourceLost || m_fileName.empty()) {
+        return;
     }
+
+    std::cout << "DrawableImage::prefetchProcessed(): building the processed data on a worker thread." << std::endl;
+
+    m_pendingProcessed = std::async(std::launch::async, processFile, m_fileName, m_sourceStamp, m_width, m_height);
 }
 
-DrawableImage::~DrawableImage() {
-    glDeleteTextures (1, &m_rawTextureId);
-    glDeleteTextures (1, &m_processedTextureId);
+/*
+ * Takes a finished prefetch off the future so its result does not sit there outside the budget. The keys and
+ * statistics are adopted; the float edge map is freed unless a tool holds one. Returns at once while the
+ * worker is still busy.
+ */
+void DrawableImage::collectPrefetch() {
+    if (!m_pendingProcessed.valid() || m_pendingProcessed.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+
+    ProcessedData data = m_pendingProcessed.get();
+
+    if (!data.ok) {
+        m_prefetchFailed = true;
+
+        std::cout << "DrawableImage::collectPrefetch(): the prefetch could not decode the source." << std::endl;
+        return;
+    }
+
+    if (m_edgeKeys.empty()) {
+        adoptProcessedData(std::move(data));
+    }
+}
+
+GLuint DrawableImage::uploadTexture(const uint8_t* pixels, const size_t width, const size_t height, const size_t rowLength,
+                                    const GLenum format) {
+    GLuint textureId = 0;
+
+    glGenTextures(1, &textureId);
+    std::cout << "DrawableImage::uploadTexture(): generated texture id: " << textureId << std::endl;
+
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // GL_LINEAR
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // GL_LINEAR
+
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    return textureId;
+}
+
+void DrawableImage::uploadRawTexture(const RgbImage& rawImage) {
+    m_rawTextureId = uploadTexture(rawImage.data(), m_width, m_height, rawImage.stride(), GL_RGB);
+}
+
+/*
+ * The processed view is gray, so it goes up as a single channel luminance texture, a third of the memory
+ * of the RGB one. The 8 bit buffer only lives for the upload.
+ */
+void DrawableImage::uploadProcessedTexture() {
+    const std::vector<uint8_t> pixels = applyDisplayLut(m_edgeKeys, buildDisplayLut(m_displayWindow), 1);
+    m_processedTextureId = uploadTexture(pixels.data(), m_width, m_height, m_width, GL_LUMINANCE);
+}
+
+void DrawableImage::releaseTextures() {
+    if (m_rawTextureId) {
+        glDeleteTextures(1, &m_rawTextureId);
+        m_rawTextureId = 0;
+    }
+
+    if (m_processedTextureId) {
+        glDeleteTextures(1, &m_processedTextureId);
+        m_processedTextureId = 0;
+    }
+
+    if (m_detailTextureId) {
+        glDeleteTextures(1, &m_detailTextureId);
+        m_detailTextureId = 0;
+    }
+}
+
+/*
+ * Drops both textures, the display keys and any prefetch. Derived maps still owned by a running tool stay
+ * alive until the tool lets go of them. The render functions decode the source again and rebuild whatever is
+ * missing the next time the image is drawn. The caller must have the GL context that owns the textures current.
+ *
+ * A source that changed on disk could not be rebuilt from, so its resident data is kept instead.
+ */
+void DrawableImage::evict() {
+    if (m_sourceLost || fileStamp(m_fileName) != m_sourceStamp) {
+        m_sourceLost = true;
+
+        std::cout << "DrawableImage::evict(): " << m_fileName << " changed on disk, keeping its resident data." << std::endl;
+        return;
+    }
+
+    releaseTextures();
+
+    // A prefetch cannot be cancelled; wait for it and drop what it built.
+    if (m_pendingProcessed.valid()) {
+        m_pendingProcessed.wait();
+        m_pendingProcessed = std::future<ProcessedData>();
+    }
+
+    std::vector<uint16_t>().swap(m_edgeKeys);
+    std::vector<uint32_t>().swap(m_edgeStats.histogram);
+
+    if (m_tiles) {
+        m_tiles->clearCache();
+    }
+
+    std::cout << "DrawableImage::evict(): released textures and derived buffers." << std::endl;
+}
+
+void DrawableImage::memoryUsage(std::vector<BufferBytes>* buffers) const {
+    const std::shared_ptr<const GrayImage> edges = m_edgeMap.lock();
+    const std::shared_ptr<const GrayImage> distance = m_distanceMap.lock();
+    const std::shared_ptr<const IndexImage> nearest = m_nearestEdge.lock();
+
+    const size_t pixels = m_width * m_height;
+
+    // A prefetch in flight, or done and not collected yet, holds an edge map, its keys and a histogram.
+    const size_t prefetchBytes = m_pendingProcessed.valid() ?
+                                 pixels * (sizeof(float) + sizeof(uint16_t)) + kHistogramBins * sizeof(uint32_t) : 0;
+
+    const BufferBytes usage[] = {
+        { "display keys",       m_edgeKeys.size() * sizeof(uint16_t),                   false },
+        { "edge histogram",     m_edgeStats.histogram.size() * sizeof(uint32_t),        false },
+        { "edge map",           edges ? edges->bytes() : 0,                             false },
+        { "distance map",       distance ? distance->bytes() : 0,                       false },
+        { "nearest edge",       nearest ? nearest->bytes() : 0,                         false },
+        { "processed prefetch", prefetchBytes,                                          false },
+        { "tile cache",         m_tiles ? m_tiles->cacheBytes() : 0,                    false },
+        { "raw texture",        m_rawTextureId ? pixels * kBytesPerPixel : 0,           true  },
+        { "processed texture",  m_processedTextureId ? pixels : 0,                      true  },
+        { "tile detail texture", m_detailTextureId ? m_detailWidth * m_detailHeight : 0, true  }
+    };
+
+    buffers->insert(buffers->end(), usage, usage + sizeof(usage) / sizeof(usage[0]));
 }
 
 void DrawableImage::setFlip(const bool x, const bool y) {
@@ -144,12 +503,152 @@ void DrawableImage::scale(const float k) {
     m_yScale = k;
 }
 
+const ViewRect& DrawableImage::view() const {
+    return m_view;
+}
+
+/*
+ * Zooms the view by factor (above 1 zooms in) about the image point (x, y), which stays where it is on
+ * screen. The view keeps the image's aspect ratio and stays inside the image.
+ */
+void DrawableImage::zoom(const float factor, const float x, const float y) {
+    if (m_width == 0 || m_height == 0) {
+        return;
+    }
+
+    const float minWidth = std::min<float>(m_width, kMinViewPixels / m_tileScale);
+    const float width = std::max(minWidth, std::min<float>(m_width, m_view.width / factor));
+    const float height = width * m_height / m_width;
+    const float ratio = width / m_view.width;
+
+    m_view.x        = std::max(0.0f, std::min(m_width - width, x - (x - m_view.x) * ratio));
+    m_view.y        = std::max(0.0f, std::min(m_height - height, y - (y - m_view.y) * ratio));
+    m_view.width    = width;
+    m_view.height   = height;
+}
+
 void DrawableImage::rotate(size_t m_angle) {
     m_angle = m_angle;
 }
 
+/*
+ * Rebuilds the processed texture for a new display window. Only the 16 bit keys cached with the edge map
+ * are touched, so this is cheap enough to call on every key press.
+ */
+void DrawableImage::setDisplayWindow(const DisplayWindow& window) {
+    m_displayWindow = window;
+    m_hasDisplayWindow = true;
+
+    // An evicted image picks the new window up when it is rebuilt.
+    if (m_edgeKeys.empty() || m_processedTextureId == 0) {
+        return;
+    }
+
+    Timer timer;
+    timer.tick();
+    const std::vector<uint8_t> pixels = applyDisplayLut(m_edgeKeys, buildDisplayLut(m_displayWindow), 1);
+
+    glBindTexture(GL_TEXTURE_2D, m_processedTextureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, GL_LUMINANCE, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::cout << "DrawableImage::setDisplayWindow(): low, high, gamma: " << window.low << ", " << window.high << ", " << window.gamma
+              << " in " << timer.tock() << " ms." << std::endl;
+}
+
+/*
+ * The edge map is shared rather than copied with tools that run on other threads (the snake solver). The
+ * image does not keep it: while a tool holds it, it is found again here; once the last tool lets go it is
+ * freed and the next request rebuilds it from the source file.
+ */
+std::shared_ptr<const GrayImage> DrawableImage::edgeMap() {
+    std::shared_ptr<const GrayImage> edges = m_edgeMap.lock();
+
+    if (!edges && !m_fileName.empty()) {
+        edges = buildProcessedData();
+    }
+
+    return edges;
+}
+
+/*
+ * Thresholds the edge map at kEdgeThresholdPercentile and runs the distance transform on it. Only contour
+ * tools need this, so it is built on first use rather than with the rest of the processed data. The nearest
+ * edge index map is only filled when nearest is given; the snake needs just the distances. The caller holds
+ * edges for the duration, since the image itself only keeps a weak reference to it.
+ */
+void DrawableImage::buildDistanceMap(const std::shared_ptr<const GrayImage>& edges, std::shared_ptr<const GrayImage>* distance,
+                                     std::shared_ptr<const IndexImage>* nearest) {
+    if (!edges) {
+        return;
+    }
+
+    Timer timer;
+    timer.tick();
+
+    const float threshold = edgeStats().percentile(kEdgeThresholdPercentile);
+
+    GrayImage* distanceImage = new GrayImage();
+    IndexImage* nearestImage = nearest ? new IndexImage() : NULL;
+
+    distanceTransform(*edges, threshold, distanceImage, nearestImage);
+
+    distance->reset(distanceImage);
+    m_distanceMap = *distance;
+
+    if (nearest) {
+        nearest->reset(nearestImage);
+        m_nearestEdge = *nearest;
+    }
+
+    std::cout << "DrawableImage::buildDistanceMap(): threshold " << threshold << ", distance transform time: " << timer.tock() << " ms." << std::endl;
+}
+
+std::shared_ptr<const GrayImage> DrawableImage::distanceMap() {
+    std::shared_ptr<const GrayImage> distance = m_distanceMap.lock();
+
+    if (!distance) {
+        buildDistanceMap(edgeMap(), &distance, NULL);
+    }
+
+    return distance;
+}
+
+std::shared_ptr<const IndexImage> DrawableImage::nearestEdge() {
+    std::shared_ptr<const GrayImage> distance;
+    std::shared_ptr<const IndexImage> nearest = m_nearestEdge.lock();
+
+    if (!nearest) {
+        buildDistanceMap(edgeMap(), &distance, &nearest);
+    }
+
+    return nearest;
+}
+
+const DisplayWindow& DrawableImage::displayWindow() const {
+    return m_displayWindow;
+}
+
+const ImageStats& DrawableImage::edgeStats() {
+    if (m_edgeStats.histogram.empty() && !m_fileName.empty()) {
+        buildProcessedData();
+    }
+
+    return m_edgeStats;
+}
+
 void DrawableImage::renderRawData() {
-    assert(m_rawImage.size() > 0);
+    assert(!m_fileName.empty());
+
+    if (m_rawTextureId == 0) {
+        const RgbImage rawImage = loadSource();
+
+        if (rawImage.empty()) {
+            return;
+        }
+
+        uploadRawTexture(rawImage);
+    }
 
     glLoadIdentity();
     glTranslatef(m_xPos, m_yPos, 0);
@@ -158,6 +657,8 @@ void DrawableImage::renderRawData() {
         glScalef(m_xScale, m_yScale, 1.0);
     }
 
+    glTranslatef(-m_view.x, -m_view.y, 0);
+
     if (m_angle != 0) {
         glRotatef(m_angle, 0, 0, 1);   
     }
@@ -185,11 +686,105 @@ void DrawableImage::renderRawData() {
     glVertex2i(m_width, 0);
     glEnd();
 
+    if (m_tiles) {
+        renderTileDetail();
+    }
+
     //glPopMatrix();
 }
 
+/*
+ * Once a tiled image is zoomed in far enough that the visible region fits in kTileDetailMaxSize pixels a
+ * side, reads that region from the tiles at full resolution and draws it over the magnified overview. The
+ * region is only read again when the view changes; panning back over recent tiles hits the reader's cache.
+ */
+void DrawableImage::renderTileDetail() {
+    if (m_tileScale <= 1) {
+        return;
+    }
+
+    const size_t x0 = static_cast<size_t>(m_view.x * m_tileScale);
+    const size_t y0 = static_cast<size_t>(m_view.y * m_tileScale);
+    const size_t x1 = std::min<size_t>(m_tiles->width(), static_cast<size_t>(std::ceil((m_view.x + m_view.width) * m_tileScale)));
+    const size_t y1 = std::min<size_t>(m_tiles->height(), static_cast<size_t>(std::ceil((m_view.y + m_view.height) * m_tileScale)));
+
+    if (x1 <= x0 || y1 <= y0 || x1 - x0 > kTileDetailMaxSize || y1 - y0 > kTileDetailMaxSize) {
+        return;
+    }
+
+    if (m_detailTextureId == 0 || x0 != m_detailX || y0 != m_detailY || x1 - x0 != m_detailWidth || y1 - y0 != m_detailHeight) {
+        Timer timer;
+        timer.tick();
+
+        GrayImage region;
+        m_tiles->readRegion(x0, y0, x1 - x0, y1 - y0, &region);
+
+        // Same stretch to the stored value range as the overview.
+        const float range = m_tiles->maxValue() - m_tiles->minValue();
+        const float valueScale = (range > 0.0f) ? (255.0f / range) : 0.0f;
+
+        std::vector<uint8_t> pixels(region.width() * region.height());
+
+        for (size_t i = 0; i < region.height(); ++i) {
+            const float* src = region.row(i);
+            uint8_t* dst = pixels.data() + i * region.width();
+
+            for (size_t j = 0; j < region.width(); ++j) {
+                dst[j] = static_cast<uint8_t>((src[j] - m_tiles->minValue()) * valueScale);
+            }
+        }
+
+        if (m_detailTextureId) {
+            glDeleteTextures(1, &m_detailTextureId);
+        }
+
+        m_detailTextureId   = uploadTexture(pixels.data(), region.width(), region.height(), region.width(), GL_LUMINANCE);
+        m_detailX           = x0;
+        m_detailY           = y0;
+        m_detailWidth       = region.width();
+        m_detailHeight      = region.height();
+
+        std::cout << "DrawableImage::renderTileDetail(): paged in " << m_detailWidth << " x " << m_detailHeight << " at "
+                  << m_detailX << ", " << m_detailY << " in " << timer.tock() << " ms." << std::endl;
+    }
+
+    const float left    = static_cast<float>(m_detailX) / m_tileScale;
+    const float top     = static_cast<float>(m_detailY) / m_tileScale;
+    const float right   = static_cast<float>(m_detailX + m_detailWidth) / m_tileScale;
+    const float bottom  = static_cast<float>(m_detailY + m_detailHeight) / m_tileScale;
+
+    // Luminance textures are undefined under GL_DECAL.
+    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glBindTexture(GL_TEXTURE_2D, m_detailTextureId);
+
+    glBegin(GL_QUADS);
+        glTexCoord2i(0, 0);
+        glVertex2f(left, top);
+
+        glTexCoord2i(0, 1);
+        glVertex2f(left, bottom);
+
+        glTexCoord2i(1, 1);
+        glVertex2f(right, bottom);
+
+        glTexCoord2i(1, 0);
+        glVertex2f(right, top);
+    glEnd();
+}
+
 void DrawableImage::renderProcessedData() {
-    assert(m_processedImage.size() > 0);
+    if (m_processedTextureId == 0) {
+        // Built on the first request for the processed view, or collected from a prefetch.
+        if (m_edgeKeys.empty()) {
+            buildProcessedData();
+        }
+
+        if (m_edgeKeys.empty()) {
+            return;
+        }
+
+        uploadProcessedTexture();
+    }
 
     glLoadIdentity();
     glTranslatef(m_xPos, m_yPos, 0);
@@ -198,11 +793,14 @@ void DrawableImage::renderProcessedData() {
         glScalef(m_xScale, m_yScale, 1.0);
     }
 
+    glTranslatef(-m_view.x, -m_view.y, 0);
+
     if (m_angle != 0) {
         glRotatef(m_angle, 0, 0, 1);   
     }
 
-    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_DECAL);
+    // Luminance textures are undefined under GL_DECAL.
+    glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
 
     glBindTexture(GL_TEXTURE_2D, m_processedTextureId);
     glEnable(GL_TEXTURE_2D);
@@ -234,27 +832,47 @@ size_t DrawableImage::height() {
     return m_height;
 }
 
-Eigen::MatrixXf rgbToGray(const std::vector<uint8_t>& rawImage, const size_t width, const size_t height) {
-    Eigen::MatrixXf I(height, width);
+/*
+ * Tiled images written by the streaming pipeline are too large to load whole; show their overview instead,
+ * stretched to the stored value range. The full resolution tiles stay on disk behind TiledImageReader.
+ */
+static bool loadTiledImageOverview(const std::string& path, RgbImage* imageData, size_t* imageWidth, size_t* imageHeight) {
+    TiledImageReader reader;
+    GrayImage overview;
+    size_t scale = 1;
+
+    if (!reader.open(path) || !reader.readOverview(&overview, &scale)) {
+        return false;
+    }
+
+    std::cout << "\nloadTiledImageOverview(): " << path << " is a tiled " << reader.width() << " x " << reader.height()
+              << " image, showing its 1:" << scale << " overview." << std::endl;
+
+    (*imageWidth)   = overview.width();
+    (*imageHeight)  = overview.height();
 
-    for (size_t i = 0; i < height; ++i) {
-        for (size_t j = 0; j < width; ++j) {
-            const size_t idx = (i * width + j) * kBytesPerPixel;
+    const float range = reader.maxValue() - reader.minValue();
+    const float valueScale = (range > 0.0f) ? (255.0f / range) : 0.0f;
 
-            const float red = rawImage[idx + 0];
-            const float grn = rawImage[idx + 1];
-            const float blu = rawImage[idx + 2];
+    imageData->resize(*imageWidth, *imageHeight);
 
-            const float gray = (0.2126f * red + 0.7512f * grn + 0.0722 * blu);
+    for (size_t i = 0; i < *imageHeight; ++i) {
+        const float* src = overview.row(i);
+        uint8_t* dst = imageData->row(i);
 
-            I(i, j) = gray;
+        for (size_t j = 0; j < *imageWidth; ++j) {
+            const uint8_t value = static_cast<uint8_t>((src[j] - reader.minValue()) * valueScale);
+
+            dst[j * kBytesPerPixel + 0] = value;
+            dst[j * kBytesPerPixel + 1] = value;
+            dst[j * kBytesPerPixel + 2] = value;
         }
     }
 
-    return I;
+    return true;
 }
 
-std::vector<uint8_t> loadImage(wxString path, size_t* imageWidth, size_t* imageHeight) {
+bool decodeImage(const wxString& path, RgbImage* imageData, size_t* imageWidth, size_t* imageHeight) {
     // the first time, init image handlers (remove this part if you do it somewhere else in your app)
     static bool is_first_time = true;
 
@@ -265,133 +883,47 @@ std::vector<uint8_t> loadImage(wxString path, size_t* imageWidth, size_t* imageH
 
     // check the file exists
     if(!wxFileExists(path)) {
-        wxMessageBox( _("Failed to load resource image") );
-        exit(1);    
+        return false;
     }
 
-    wxImage* img = new wxImage(path);
-
-    std::cout << "\nwxImageLoader::loadImage(): now loading: " << path << "." << std::endl;
-
-    (*imageWidth)   = (size_t) img->GetWidth();
-    (*imageHeight)  = (size_t) img->GetHeight();
-
-    std::cout << "wxImageLoader::loadImage(): width, height: " << *imageWidth << ", " << *imageHeight << ".\n" << std::endl;
-
-    size_t imageSize = img->GetWidth() * img->GetHeight() * kBytesPerPixel;
-
-    std::vector<uint8_t> imageData;
-    imageData.resize(imageSize);
-
-    memset(imageData.data(), 0, imageSize);
-    memcpy(imageData.data(), img->GetData(), imageSize);
-
-    delete img;
-
-    return imageData;
-}
-
-std::vector<uint8_t> matToImage(const Eigen::MatrixXf& matrix) {
-    std::vector<uint8_t> image;
-    image.resize(matrix.rows() * matrix.cols() * kBytesPerPixel);
-
-    const float oldMin = matrix.minCoeff();
-    const float oldMax = matrix.maxCoeff();
-    const float newMin = 0.0;
-    const float newMax = 255.0;
-
-    std::cout << "oldMin, oldMax: " << oldMin << ", " << oldMax << std::endl;
-    const float valueRange = (newMax - newMin) / (oldMax - oldMin);
-
-    for (size_t i = 0; i < matrix.rows(); ++i) {
-        for (size_t j = 0; j < matrix.cols(); ++j) {
-            const size_t idx = (i * matrix.cols()  + j) * kBytesPerPixel;
-
+    if (isTiledImage(path.ToStdString())) {
+        return loadTiledImageOverview(path.ToStdString(), imageData, imageWidth, imageHeight);
+    }
 
-            const float newVal = (matrix(i, j) - oldMin) * valueRange + newMin;
+    wxImage* img = new wxImage(path);
 
-            image[idx + 0] = static_cast<uint8_t>(newVal);
-            image[idx + 1] = static_cast<uint8_t>(newVal);
-            image[idx + 2] = static_cast<uint8_t>(newVal);
-        }
+    if (!img->IsOk()) {
+        delete img;
+        return false;
     }
 
-    return image;
-}
-
+    std::cout << "\ndecodeImage(): now loading: " << path << "." << std::endl;
 
-Eigen::MatrixXf computeEdgeMap(const Eigen::MatrixXf& I, const bool useConvolution) {
-    Eigen::MatrixXf edgeMap(I.rows(), I.cols());
+    (*imageWidth)   = (size_t) img->GetWidth();
+    (*imageHeight)  = (size_t) img->GetHeight();
 
-    Eigen::MatrixXf dx(3, 3);
-    Eigen::MatrixXf dy(3, 3);
+    std::cout << "decodeImage(): width, height: " << *imageWidth << ", " << *imageHeight << ".\n" << std::endl;
 
-    dx(0, 0) = 1.0;     dx(0, 1) = 0.0;     dx(0, 2) = -1.0;
-    dx(1, 0) = 2.0;     dx(1, 1) = 0.0;     dx(1, 2) = -2.0;
-    dx(2, 0) = 1.0;     dx(2, 1) = 0.0;     dx(2, 2) = -1.0;
+    const size_t rowSize = (*imageWidth) * kBytesPerPixel;
 
-    dy(0, 0) = 1.0;     dy(0, 1) = 2.0;     dy(0, 2) = 1.0;
-    dy(1, 0) = 0.0;     dy(1, 1) = 0.0;     dy(1, 2) = 0.0;
-    dy(2, 0) = -1.0;    dy(2, 1) = -2.0;    dy(2, 2) = -1.0;
+    imageData->resize(*imageWidth, *imageHeight);
 
-    Eigen::MatrixXf Gx;
-    Eigen::MatrixXf Gy;
-    
-    if (useConvolution) {
-        Gx = conv2d(I, dx);
-        Gy = conv2d(I, dy);
-    }
-    else {
-        Gx = I.rightCols(I.cols() - 1) - I.leftCols(I.cols() - 1);
-        Gy = I.bottomRows(I.rows() - 1) - I.topRows(I.rows() - 1);
-        Gx.conservativeResizeLike(Eigen::MatrixXf(I.rows(), I.cols()));
-        Gy.conservativeResizeLike(Eigen::MatrixXf(I.rows(), I.cols()));
+    for (size_t i = 0; i < *imageHeight; ++i) {
+        memcpy(imageData->row(i), img->GetData() + i * rowSize, rowSize);
     }
 
-    Gx = Gx.array().square();
-    Gy = Gy.array().square();
-
-    std::cout << "Gx rows, cols: " << Gx.rows() << ", " << Gx.cols() << std::endl;
-    std::cout << "Gy rows, cols: " << Gy.rows() << ", " << Gy.cols() << std::endl;
+    delete img;
 
-    edgeMap = Gx + Gy;
-    edgeMap = edgeMap.array().sqrt();
-    
-    return edgeMap;
+    return true;
 }
 
-template <typename Derived, typename Derived2>
-Derived conv2d(const Eigen::MatrixBase<Derived>& I, const Eigen::MatrixBase<Derived2> &kernel) {
-    Derived O = Derived::Zero(I.rows(), I.cols());
+RgbImage loadImage(wxString path, size_t* imageWidth, size_t* imageHeight) {
+    RgbImage imageData;
 
-
-    typedef typename Derived::Scalar Scalar;
-
-    Derived2 block;
-    Scalar normalization = kernel.sum();
-    
-    if (normalization < 1E-6) {
-        normalization = 1;
-    } 
-
-    Derived2 tempBlock1;
-    Derived2 tempBlock2;
-    
-    const size_t kernelRows = kernel.rows();
-    const size_t kernelCols = kernel.cols();
-
-    const size_t rowUpperBound = I.rows() - kernelRows;
-    const size_t colUpperBound = I.cols() - kernelCols;
-
-    for (size_t i = kernelRows; i < rowUpperBound; i++) {
-        for (size_t j = kernelCols; j < colUpperBound; j++ ) {
-            tempBlock1 = (I.block(i, j, kernelRows, kernelCols));
-            tempBlock2 = tempBlock1.cwiseProduct(kernel);
-            Scalar b = tempBlock2.sum();
-            //Scalar b = (static_cast<Derived2>(I.block(i, j, kernelRows, kernelCols)).cwiseProduct(kernel)).sum();
-            O.coeffRef(i, j) = b;
-        }
+    if (!decodeImage(path, &imageData, imageWidth, imageHeight)) {
+        wxMessageBox( _("Failed to load resource image") );
+        exit(1);    
     }
 
-    return O / normalization;
+    return imageData;
 }
@@ -60,20 +60,64 @@
 
 #include <wx/wx.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "DistanceTransform.hpp"
+#include "FileStamp.hpp"
+#include "Image.hpp"
+#include "ImageProcessing.hpp"
+#include "ImageStats.hpp"
+#include "ResidencyManager.hpp"
+#include "TiledImage.hpp"
 #include "Timer.hpp"
 
-const size_t kBytesPerPixel = 3;
+/*
+ * When the processed channel (edge map, statistics, display keys and the processed texture) is built. On
+ * demand is the default: the first frame only waits for the decode and the raw texture, and the processed
+ * data is built the first time something asks for it. Prefetch builds it on a worker thread right after the
+ * raw texture is up, and eager builds it before the first frame, as the viewer always used to.
+ */
+enum ProcessedChannel {
+    kProcessedOnDemand,
+    kProcessedPrefetch,
+    kProcessedEager
+};
+
+// The part of the image shown in the window, in image pixels. The whole image unless zoomed in.
+struct ViewRect {
+    float   x;
+    float   y;
+    float   width;
+    float   height;
+};
+
+// Zooming in stops once this many full resolution pixels span the window.
+const float  kMinViewPixels         = 64.0f;
+
+// A tiled image pages in its full resolution tiles once the visible region is at most this many pixels a
+// side, about what the reader's tile cache holds.
+const size_t kTileDetailMaxSize     = 2048;
+
+// Rows decoded per readRows() call when a prefetch decodes the source itself.
+const size_t kPrefetchStripRows     = 64;
 
-struct snaxel {
-    size_t x;
-    size_t y;
+// Everything the processing chain produces from the raw pixels; built off the GL thread by a prefetch.
+struct ProcessedData {
+    bool                                ok;     // false if the source could not be decoded
+    std::shared_ptr<const GrayImage>    edgeMap;
+    ImageStats                          stats;
+    std::vector<uint16_t>               keys;
 };
 
-class DrawableImage {
+class DrawableImage : public ResidentDocument {
     private:
         float                   m_xScale;
         float                   m_yScale;
@@ -92,18 +136,65 @@ class DrawableImage {
         bool                    m_xFlip;
         bool                    m_yFlip;
         
-        std::vector<uint8_t>    m_rawImage;
-        std::vector<uint8_t>    m_processedImage;
-        
-        Eigen::MatrixXf         m_edgeMap;
+        // The pixels live in the textures; the source file is decoded again whenever the CPU needs them.
+        std::string             m_fileName;
+
+        // Path, modification time and size of the source when it was opened. A rebuild from a file that no
+        // longer matches it is refused and the image is marked lost instead.
+        std::string             m_sourceStamp;
+        bool                    m_sourceLost;
+
+        // Only tools that are running (the snake solver) own these; the image just finds them again while
+        // they are alive.
+        std::weak_ptr<const GrayImage>      m_edgeMap;
+        std::weak_ptr<const GrayImage>      m_distanceMap;
+        std::weak_ptr<const IndexImage>     m_nearestEdge;
+
+        // The 16 bit keys are the compact cache the processed texture is rebuilt from on a display window
+        // change, 2 bytes a pixel against 4 for the float edge map.
+        ImageStats              m_edgeStats;
+        std::vector<uint16_t>   m_edgeKeys;
+        DisplayWindow           m_displayWindow;
+        bool                    m_hasDisplayWindow;
 
         GLuint                  m_rawTextureId;
         GLuint                  m_processedTextureId;
 
+        ViewRect                m_view;
+
+        // Tiled images show their overview; the reader stays open so the visible tiles can be paged in at
+        // full resolution when zoomed in. The detail texture holds the full resolution region it was read from.
+        std::unique_ptr<TiledImageReader>   m_tiles;
+        size_t                  m_tileScale;
+        GLuint                  m_detailTextureId;
+        size_t                  m_detailX;
+        size_t                  m_detailY;
+        size_t                  m_detailWidth;
+        size_t                  m_detailHeight;
+
+        // Processed data being built by a prefetch, collected by the first render after it is done or by the
+        // first request that needs it. A prefetch that could not decode the source is not retried.
+        std::future<ProcessedData>          m_pendingProcessed;
+        bool                                m_prefetchFailed;
+
+        RgbImage                            loadSource();
+        std::shared_ptr<const GrayImage>    buildProcessedData();
+        std::shared_ptr<const GrayImage>    adoptProcessedData(ProcessedData data);
+        void    buildDistanceMap(const std::shared_ptr<const GrayImage>& edges, std::shared_ptr<const GrayImage>* distance,
+                                 std::shared_ptr<const IndexImage>* nearest);
+        GLuint  uploadTexture(const uint8_t* pixels, const size_t width, const size_t height, const size_t rowLength, const GLenum format);
+        void    uploadRawTexture(const RgbImage& rawImage);
+        void    uploadProcessedTexture();
+        void    releaseTextures();
+        void    renderTileDetail();
+
     public:
-        DrawableImage(const char* fileName);
+        DrawableImage(const char* fileName, const ProcessedChannel processedChannel = kProcessedOnDemand);
         ~DrawableImage();
 
+        void prefetchProcessed();
+        void collectPrefetch();
+
         void renderRawData();
         void renderProcessedData();
        
@@ -114,16 +205,26 @@ class DrawableImage {
         void scale(const float x, const float y);
         void scale(const float k);
 
+        const ViewRect& view() const;
+        void zoom(const float factor, const float x, const float y);
+
+        void setDisplayWindow(const DisplayWindow& window);
+        const DisplayWindow& displayWindow() const;
+        const ImageStats& edgeStats();
+        std::shared_ptr<const GrayImage> edgeMap();
+        std::shared_ptr<const GrayImage> distanceMap();
+        std::shared_ptr<const IndexImage> nearestEdge();
+
         size_t  width();
         size_t  height();
-};
+        bool    sourceLost() const;
 
-std::vector<uint8_t> loadImage(wxString path, size_t* imageWidth, size_t* imageHeight);
-Eigen::MatrixXf rgbToGray(const std::vector<uint8_t>& rawImage, const size_t width, const size_t height);
-std::vector<uint8_t> matToImage(const Eigen::MatrixXf& matrix);
-Eigen::MatrixXf computeEdgeMap(const Eigen::MatrixXf& grayImage, const bool useConvoltion = true);
+        // ResidentDocument
+        void    memoryUsage(std::vector<BufferBytes>* buffers) const;
+        void    evict();
+};
 
-template <typename Derived, typename Derived2>
-Derived conv2d(const Eigen::MatrixBase<Derived>& I, const Eigen::MatrixBase<Derived2> &kernel);
+bool decodeImage(const wxString& path, RgbImage* imageData, size_t* imageWidth, size_t* imageHeight);
+RgbImage loadImage(wxString path, size_t* imageWidth, size_t* imageHeight);
 
 #endif
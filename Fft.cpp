@@ -0,0 +1,225 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Fft.cpp
+ *
+ * The following implements self-contained radix-2 fast Fourier transforms and the
+ * plan cache.
+ *
+ ****************************************************************************
+ */
+
+#include "Fft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+/*
+ * std::complex multiplication goes through a library call that handles infinities and NaNs; transform
+ * inputs are finite, so multiply by hand.
+ */
+static inline Complex multiply(const Complex& a, const Complex& b) {
+    return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+
+static std::vector<uint32_t> bitReversal(const size_t n) {
+    std::vector<uint32_t> table(n, 0);
+
+    size_t bits = 0;
+    while ((size_t(1) << bits) < n) {
+        ++bits;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t reversed = 0;
+
+        for (size_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+
+        table[i] = reversed;
+    }
+
+    return table;
+}
+
+size_t nextPowerOfTwo(const size_t n) {
+    size_t p = 1;
+
+    while (p < n) {
+        p <<= 1;
+    }
+
+    return p;
+}
+
+FftPlan::FftPlan(const size_t n) : m_size(n), m_twiddles(n / 2), m_bitReverse(bitReversal(n)), m_halfBitReverse(bitReversal(n / 2)) {
+    for (size_t k = 0; k < n / 2; ++k) {
+        const double angle = -2.0 * M_PI * k / n;
+        m_twiddles[k] = Complex(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+}
+
+/*
+ * Iterative decimation in time transform of a length that divides n; the twiddles of a stage of length len
+ * are every (n / len)th twiddle of the full table.
+ */
+void FftPlan::radix2(Complex* data, const size_t length, const uint32_t* bitReverse, const bool inverse) const {
+    for (size_t i = 0; i < length; ++i) {
+        if (i < bitReverse[i]) {
+            std::swap(data[i], data[bitReverse[i]]);
+        }
+    }
+
+    for (size_t len = 2; len <= length; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = m_size / len;
+
+        for (size_t i = 0; i < length; i += len) {
+            for (size_t k = 0; k < half; ++k) {
+                const Complex u = data[i + k];
+                const Complex v = multiply(data[i + k + half], twiddle(k * step, inverse));
+
+                data[i + k]         = u + v;
+                data[i + k + half]  = u - v;
+            }
+        }
+    }
+}
+
+void FftPlan::transform(Complex* data, const bool inverse) const {
+    radix2(data, m_size, m_bitReverse.data(), inverse);
+}
+
+/*
+ * Same butterflies as radix2(), applied to whole rows at once so the inner loop runs along contiguous
+ * memory instead of striding down one column at a time.
+ */
+void FftPlan::transformColumns(Complex* data, const size_t columns, const bool inverse) const {
+    for (size_t i = 0; i < m_size; ++i) {
+        if (i < m_bitReverse[i]) {
+            std::swap_ranges(data + i * columns, data + (i + 1) * columns, data + m_bitReverse[i] * columns);
+        }
+    }
+
+    for (size_t len = 2; len <= m_size; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = m_size / len;
+
+        for (size_t i = 0; i < m_size; i += len) {
+            for (size_t k = 0; k < half; ++k) {
+                const Complex w = twiddle(k * step, inverse);
+                Complex* top = data + (i + k) * columns;
+                Complex* bottom = data + (i + k + half) * columns;
+
+                for (size_t c = 0; c < columns; ++c) {
+                    const Complex u = top[c];
+                    const Complex v = multiply(bottom[c], w);
+
+                    top[c]      = u + v;
+                    bottom[c]   = u - v;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * The even and odd samples go in as the real and imaginary parts of a half length transform Z; the
+ * spectrum is untangled with E[k] = (Z[k] + conj(Z[n/2 - k])) / 2, O[k] = (Z[k] - conj(Z[n/2 - k])) / 2i and
+ * X[k] = E[k] + W^k O[k], one (k, n/2 - k) pair at a time so it can be done in place.
+ */
+void FftPlan::forwardReal(const float* in, Complex* out) const {
+    const size_t half = m_size / 2;
+
+    for (size_t m = 0; m < half; ++m) {
+        out[m] = Complex(in[2 * m], in[2 * m + 1]);
+    }
+
+    radix2(out, half, m_halfBitReverse.data(), false);
+
+    const Complex z0 = out[0];
+    out[0]      = Complex(z0.real() + z0.imag(), 0.0f);
+    out[half]   = Complex(z0.real() - z0.imag(), 0.0f);
+
+    for (size_t k = 1; k <= half / 2; ++k) {
+        const Complex a = out[k];
+        const Complex b = std::conj(out[half - k]);
+
+        const Complex even  = 0.5f * (a + b);
+        const Complex odd   = multiply(Complex(0.0f, -0.5f), a - b);
+        const Complex w     = m_twiddles[k];
+
+        out[k]          = even + multiply(w, odd);
+        out[half - k]   = std::conj(even) - multiply(std::conj(w), std::conj(odd));
+    }
+}
+
+/*
+ * Reverses forwardReal(): 2E[k] = X[k] + conj(X[n/2 - k]) and 2O[k] = (X[k] - conj(X[n/2 - k])) conj(W^k),
+ * then an inverse half length transform of 2E + 2i O. The output doubles as the complex work space.
+ */
+void FftPlan::inverseReal(const Complex* in, float* out) const {
+    const size_t half = m_size / 2;
+    Complex* z = reinterpret_cast<Complex*>(out);
+
+    for (size_t k = 0; k < half; ++k) {
+        const Complex a = in[k];
+        const Complex b = std::conj(in[half - k]);
+
+        const Complex even  = a + b;
+        const Complex odd   = multiply(a - b, std::conj(m_twiddles[k]));
+
+        z[k] = even + multiply(Complex(0.0f, 1.0f), odd);
+    }
+
+    radix2(z, half, m_halfBitReverse.data(), true);
+}
+
+std::shared_ptr<const FftPlan> fftPlan(const size_t n) {
+    static std::mutex mutex;
+    static std::map<size_t, std::shared_ptr<const FftPlan> > plans;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::shared_ptr<const FftPlan>& plan = plans[n];
+
+    if (!plan) {
+        plan.reset(new FftPlan(n));
+    }
+
+    return plan;
+}
@@ -0,0 +1,94 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Fft.hpp
+ *
+ * The following implements self-contained radix-2 fast Fourier transforms: complex
+ * transforms, transforms down the columns of a row-major array, and real transforms
+ * packed into complex transforms of half the length. Plans hold the precomputed
+ * tables for one size and are cached, so repeated transforms of a size share them.
+ *
+ ****************************************************************************
+ */
+
+#ifndef FFT_HPP
+#define FFT_HPP
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+typedef std::complex<float> Complex;
+
+/*
+ * Tables for transforms of one power of two size n (at least 4). Transforms are unnormalized: an inverse
+ * transform after a forward one scales by n, or by n * n for the two passes of a 2D transform.
+ */
+class FftPlan {
+    private:
+        size_t                  m_size;
+        std::vector<Complex>    m_twiddles;         // exp(-2 pi i k / n) for k < n / 2
+        std::vector<uint32_t>   m_bitReverse;       // index permutation for length n
+        std::vector<uint32_t>   m_halfBitReverse;   // index permutation for length n / 2
+
+        Complex twiddle(const size_t k, const bool inverse) const {
+            return inverse ? std::conj(m_twiddles[k]) : m_twiddles[k];
+        }
+
+        void radix2(Complex* data, const size_t length, const uint32_t* bitReverse, const bool inverse) const;
+
+    public:
+        explicit FftPlan(const size_t n);
+
+        size_t size() const { return m_size; }
+
+        // In place transform of n complex values.
+        void transform(Complex* data, const bool inverse) const;
+
+        // In place transform of every column of an n x columns row-major array.
+        void transformColumns(Complex* data, const size_t columns, const bool inverse) const;
+
+        // n real values to their n / 2 + 1 non-redundant coefficients, and back.
+        void forwardReal(const float* in, Complex* out) const;
+        void inverseReal(const Complex* in, float* out) const;
+};
+
+// The cached plan for size n, built on first use. Safe to call from several threads.
+std::shared_ptr<const FftPlan> fftPlan(const size_t n);
+
+size_t nextPowerOfTwo(const size_t n);
+
+#endif
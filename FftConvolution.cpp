@@ -0,0 +1,200 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: FftConvolution.cpp
+ *
+ * The following implements convolution through the FFT by overlap-add over square
+ * tiles.
+ *
+ ****************************************************************************
+ */
+
+#include "FftConvolution.hpp"
+#include "Fft.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Largest FFT size considered for a tile; beyond this the spectra stop fitting in cache.
+const size_t kMaxFftTileSize = 1024;
+
+size_t fftTileSize(const size_t kernelRows, const size_t kernelCols) {
+    // A tile must be at least as tall and wide as the kernel overlap, see conv2dFft().
+    size_t best = nextPowerOfTwo(2 * std::max(kernelRows, kernelCols));
+    double bestCost = HUGE_VAL;
+
+    for (size_t n = best; n <= std::max(best, kMaxFftTileSize); n <<= 1) {
+        const double cost = double(n) * n * std::log2(double(n)) / (double(n - kernelRows + 1) * (n - kernelCols + 1));
+
+        if (cost < bestCost) {
+            bestCost = cost;
+            best = n;
+        }
+    }
+
+    return best;
+}
+
+/*
+ * The image is first padded by the kernel size as the border mode says. The correlation of the padded image
+ * with the kernel is its convolution with the flipped kernel, whose full output C(y, x) sits at
+ * O(y - kernelRows + 1, x - kernelCols + 1). The padded image is cut into tiles of n - k + 1 pixels, each tile
+ * is convolved in an n x n transform without wrap around and its result is added into the output.
+ *
+ * Neighbouring tile rows add into kernelRows - 1 shared output rows, so even and odd tile rows run as two
+ * separate parallel passes; tiles in one row run on one thread.
+ */
+GrayImage conv2dFft(const GrayImage& I, const Eigen::MatrixXf& kernel, const BorderMode border) {
+    const size_t rows = I.height();
+    const size_t cols = I.width();
+
+    GrayImage O(cols, rows);
+
+    const size_t kernelRows = kernel.rows();
+    const size_t kernelCols = kernel.cols();
+
+    if (rows == 0 || cols == 0 || kernelRows == 0 || kernelCols == 0) {
+        return O;
+    }
+
+    const size_t top    = kernelRows / 2;
+    const size_t left   = kernelCols / 2;
+    const size_t bottom = kernelRows - 1 - top;
+    const size_t right  = kernelCols - 1 - left;
+
+    const GrayImage P = padImage(I, top, bottom, left, right, border);
+    const size_t paddedRows = P.height();
+    const size_t paddedCols = P.width();
+
+    const size_t n              = fftTileSize(kernelRows, kernelCols);
+    const size_t spectrumCols   = n / 2 + 1;
+    const size_t tileRows       = n - kernelRows + 1;
+    const size_t tileCols       = n - kernelCols + 1;
+
+    const std::shared_ptr<const FftPlan> plan = fftPlan(n);
+
+    // Spectrum of the flipped kernel, with the 1 / n^2 of the round trip folded in.
+    std::vector<Complex> kernelSpectrum(n * spectrumCols);
+    std::vector<float> line(n);
+
+    const float scale = 1.0f / (n * n);
+
+    for (size_t p = 0; p < kernelRows; ++p) {
+        std::fill(line.begin(), line.end(), 0.0f);
+
+        for (size_t q = 0; q < kernelCols; ++q) {
+            line[q] = kernel(kernelRows - 1 - p, kernelCols - 1 - q) * scale;
+        }
+
+        plan->forwardReal(line.data(), &kernelSpectrum[p * spectrumCols]);
+    }
+
+    plan->transformColumns(kernelSpectrum.data(), spectrumCols, false);
+
+    const size_t tileRowCount = (paddedRows + tileRows - 1) / tileRows;
+    const size_t tileColCount = (paddedCols + tileCols - 1) / tileCols;
+
+    const auto processTileRow = [&](const size_t tileRow, std::vector<Complex>& spectrum, std::vector<float>& buffer) {
+        const size_t y0 = tileRow * tileRows;
+        const size_t h  = std::min(tileRows, paddedRows - y0);
+
+        for (size_t tileCol = 0; tileCol < tileColCount; ++tileCol) {
+            const size_t x0 = tileCol * tileCols;
+            const size_t w  = std::min(tileCols, paddedCols - x0);
+
+            for (size_t r = 0; r < h; ++r) {
+                std::copy(P.row(y0 + r) + x0, P.row(y0 + r) + x0 + w, buffer.begin());
+                std::fill(buffer.begin() + w, buffer.end(), 0.0f);
+
+                plan->forwardReal(buffer.data(), &spectrum[r * spectrumCols]);
+            }
+
+            std::fill(spectrum.begin() + h * spectrumCols, spectrum.end(), Complex(0.0f, 0.0f));
+
+            plan->transformColumns(spectrum.data(), spectrumCols, false);
+
+            for (size_t k = 0; k < spectrum.size(); ++k) {
+                const Complex a = spectrum[k];
+                const Complex b = kernelSpectrum[k];
+
+                spectrum[k] = Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+            }
+
+            plan->transformColumns(spectrum.data(), spectrumCols, true);
+
+            // Only the part of the n x n result that lands inside the output is kept.
+            const size_t jBegin = std::max(x0, kernelCols - 1) - (kernelCols - 1);
+            const size_t jEnd   = std::min(x0 + n, cols + kernelCols - 1) - (kernelCols - 1);
+
+            for (size_t r = 0; r < n; ++r) {
+                const size_t y = y0 + r;
+
+                if (y < kernelRows - 1 || y >= rows + kernelRows - 1) {
+                    continue;
+                }
+
+                const size_t i = y - (kernelRows - 1);
+
+                plan->inverseReal(&spectrum[r * spectrumCols], buffer.data());
+
+                float* dst = O.row(i);
+
+                for (size_t j = jBegin; j < jEnd; ++j) {
+                    dst[j] += buffer[j + kernelCols - 1 - x0];
+                }
+            }
+        }
+    };
+
+    for (size_t parity = 0; parity < 2; ++parity) {
+        const size_t count = (tileRowCount + 1 - parity) / 2;
+
+        parallelFor(0, count, [&](const size_t begin, const size_t end, const size_t) {
+            std::vector<Complex> spectrum(n * spectrumCols);
+            std::vector<float> buffer(n);
+
+            for (size_t t = begin; t < end; ++t) {
+                processTileRow(2 * t + parity, spectrum, buffer);
+            }
+        });
+    }
+
+    if (border == kBorderSkip) {
+        clearBorder(&O, top, bottom, left, right);
+    }
+
+    return O;
+}
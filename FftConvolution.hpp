@@ -0,0 +1,62 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: FftConvolution.hpp
+ *
+ * The following implements convolution through the FFT for kernels too large for
+ * the direct loop, by overlap-add over square tiles.
+ *
+ ****************************************************************************
+ */
+
+#ifndef FFT_CONVOLUTION_HPP
+#define FFT_CONVOLUTION_HPP
+
+#define EIGEN_MPL2_ONLY
+#include <Eigen/Eigen>
+
+#include "Convolution.hpp"
+#include "Image.hpp"
+
+/*
+ * Same result as conv2dDirect() up to float rounding: the kernel centred on the output pixel, no
+ * normalization, and the border mode applied to the pixels outside the image. Costs O(log n) per pixel for an
+ * n x n tile instead of O(k^2).
+ */
+GrayImage conv2dFft(const GrayImage& I, const Eigen::MatrixXf& kernel, const BorderMode border = kBorderReplicate);
+
+// The FFT size used for a kernel: the power of two with the least transform work per output pixel.
+size_t fftTileSize(const size_t kernelRows, const size_t kernelCols);
+
+#endif
@@ -0,0 +1,71 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: FileStamp.cpp
+ *
+ * The following identifies a file by its canonical path, modification time and
+ * size, so a cache or an open document can tell when the file was changed.
+ *
+ ****************************************************************************
+ */
+
+#include "FileStamp.hpp"
+
+#include <sstream>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+std::string fileStamp(const std::string& path) {
+    struct stat status;
+    char canonical[PATH_MAX];
+
+    if (stat(path.c_str(), &status) != 0 || realpath(path.c_str(), canonical) == NULL) {
+        return std::string();
+    }
+
+    // Seconds alone let a file rewritten within the same second at the same length pass as unchanged.
+#ifdef __APPLE__
+    const struct timespec& modified = status.st_mtimespec;
+#else
+    const struct timespec& modified = status.st_mtim;
+#endif
+
+    std::ostringstream stamp;
+    stamp << canonical << '\n' << static_cast<long long>(modified.tv_sec) << '.' << static_cast<long>(modified.tv_nsec) << '\n'
+          << static_cast<long long>(status.st_size);
+
+    return stamp.str();
+}
@@ -0,0 +1,204 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Image.hpp
+ *
+ * The following implements a row-major image container with 64 byte aligned,
+ * padded rows. Eigen Map views are available wherever Eigen expressions are
+ * more convenient than raw row pointers.
+ *
+ ****************************************************************************
+ */
+
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+
+#define EIGEN_MPL2_ONLY
+#include <Eigen/Eigen>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+const size_t kImageRowAlignment = 64;
+
+/*
+ * Minimal allocator handing out memory aligned to Alignment bytes. The pointer returned by operator new is
+ * stashed just in front of the aligned block so deallocate() can find it again.
+ */
+template <typename T, size_t Alignment = kImageRowAlignment>
+class AlignedAllocator {
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind {
+            typedef AlignedAllocator<U, Alignment> other;
+        };
+
+        AlignedAllocator() { }
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) { }
+
+        T* allocate(const size_t n) {
+            void* raw = ::operator new(n * sizeof(T) + Alignment + sizeof(void*));
+
+            const uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + Alignment - 1) & ~(uintptr_t)(Alignment - 1);
+            reinterpret_cast<void**>(aligned)[-1] = raw;
+
+            return reinterpret_cast<T*>(aligned);
+        }
+
+        void deallocate(T* p, const size_t) {
+            if (p) {
+                ::operator delete(reinterpret_cast<void**>(p)[-1]);
+            }
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+/*
+ * Pixels are stored row after row with Channels interleaved values of type T per pixel. Each row is padded
+ * to stride() pixels so that it starts on a kImageRowAlignment boundary; the padding is zero filled. The
+ * stride is in pixels, which is what GL_UNPACK_ROW_LENGTH expects.
+ */
+template <typename T, size_t Channels = 1>
+class Image {
+    public:
+        typedef T Scalar;
+
+        typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>       Matrix;
+        typedef Eigen::Map<Matrix, Eigen::Aligned16, Eigen::OuterStride<> >             MapType;
+        typedef Eigen::Map<const Matrix, Eigen::Aligned16, Eigen::OuterStride<> >       ConstMapType;
+
+        static const size_t kChannels = Channels;
+
+    private:
+        size_t                                  m_width;
+        size_t                                  m_height;
+        size_t                                  m_stride;
+
+        std::vector<T, AlignedAllocator<T> >    m_data;
+
+        static size_t strideFor(const size_t width) {
+            // Smallest pixel count whose byte size is a multiple of the alignment.
+            size_t pixelsPerBlock = 1;
+
+            while ((pixelsPerBlock * Channels * sizeof(T)) % kImageRowAlignment != 0) {
+                ++pixelsPerBlock;
+            }
+
+            return ((width + pixelsPerBlock - 1) / pixelsPerBlock) * pixelsPerBlock;
+        }
+
+    public:
+        Image() : m_width(0), m_height(0), m_stride(0) { }
+
+        Image(const size_t width, const size_t height) : m_width(0), m_height(0), m_stride(0) {
+            resize(width, height);
+        }
+
+        void resize(const size_t width, const size_t height) {
+            m_width     = width;
+            m_height    = height;
+            m_stride    = strideFor(width);
+
+            m_data.assign(m_stride * m_height * Channels, T(0));
+        }
+
+        // Releases the storage, not just the contents.
+        void clear() {
+            std::vector<T, AlignedAllocator<T> >().swap(m_data);
+
+            m_width     = 0;
+            m_height    = 0;
+            m_stride    = 0;
+        }
+
+        size_t  width() const       { return m_width; }
+        size_t  height() const      { return m_height; }
+        size_t  stride() const      { return m_stride; }
+        size_t  channels() const    { return Channels; }
+        bool    empty() const       { return m_data.empty(); }
+
+        size_t  rowBytes() const    { return m_stride * Channels * sizeof(T); }
+        size_t  bytes() const       { return m_data.size() * sizeof(T); }
+
+        T*          data()          { return m_data.data(); }
+        const T*    data() const    { return m_data.data(); }
+
+        T*          row(const size_t i)         { return m_data.data() + i * m_stride * Channels; }
+        const T*    row(const size_t i) const   { return m_data.data() + i * m_stride * Channels; }
+
+        T& operator()(const size_t i, const size_t j, const size_t c = 0) {
+            return row(i)[j * Channels + c];
+        }
+
+        const T& operator()(const size_t i, const size_t j, const size_t c = 0) const {
+            return row(i)[j * Channels + c];
+        }
+
+        // Views the image as a height x (width * Channels) row-major matrix, padding excluded.
+        MapType map() {
+            return MapType(data(), m_height, m_width * Channels, Eigen::OuterStride<>(m_stride * Channels));
+        }
+
+        ConstMapType map() const {
+            return ConstMapType(data(), m_height, m_width * Channels, Eigen::OuterStride<>(m_stride * Channels));
+        }
+
+        // Copies the pixels into a tightly packed buffer, e.g. for APIs that cannot take a stride.
+        std::vector<T> packed() const {
+            std::vector<T> pixels(m_width * m_height * Channels);
+
+            for (size_t i = 0; i < m_height; ++i) {
+                std::copy(row(i), row(i) + m_width * Channels, pixels.begin() + i * m_width * Channels);
+            }
+
+            return pixels;
+        }
+};
+
+typedef Image<uint8_t, 3>   RgbImage;
+typedef Image<float, 1>     GrayImage;
+
+#endif
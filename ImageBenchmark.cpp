@@ -0,0 +1,693 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ImageBenchmark.cpp
+ *
+ * The following implements a command line benchmark for the processing chain.
+ * It runs on synthetic data, needs neither wxWidgets nor OpenGL, and reports
+ * wall time and, where the kernel allows it, hardware cache misses. It exits
+ * with a failure status when an optimized path disagrees with its reference.
+ * 
+ * usage: ImageBenchmark [width height]
+ *
+ ****************************************************************************
+ */
+
+#include "ColorConversion.hpp"
+#include "Convolution.hpp"
+#include "DistanceTransform.hpp"
+#include "FftConvolution.hpp"
+#include "Image.hpp"
+#include "ImageProcessing.hpp"
+#include "ImageStats.hpp"
+#include "Kernels.hpp"
+#include "Timer.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+const size_t kDefaultBenchmarkWidth     = 8000;
+const size_t kDefaultBenchmarkHeight    = 6000;
+
+/*
+ * Counts last level cache misses of this process with perf_event_open(). Reports -1 when the counter is not
+ * available (non Linux, containers, perf_event_paranoid).
+ */
+class CacheMissCounter {
+    private:
+        int m_fd;
+
+    public:
+        CacheMissCounter() : m_fd(-1) {
+#ifdef __linux__
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+
+            attr.type           = PERF_TYPE_HARDWARE;
+            attr.size           = sizeof(attr);
+            attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled       = 1;
+            attr.inherit        = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+
+            m_fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+        }
+
+        ~CacheMissCounter() {
+#ifdef __linux__
+            if (m_fd >= 0) {
+                close(m_fd);
+            }
+#endif
+        }
+
+        void start() {
+#ifdef __linux__
+            if (m_fd >= 0) {
+                ioctl(m_fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        long long stop() {
+#ifdef __linux__
+            if (m_fd >= 0) {
+                long long count = 0;
+                ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+
+                if (read(m_fd, &count, sizeof(count)) == sizeof(count)) {
+                    return count;
+                }
+            }
+#endif
+            return -1;
+        }
+};
+
+static void report(const std::string& name, const double milliseconds, const long long misses) {
+    std::cout << "  " << std::left << std::setw(36) << name << std::right << std::setw(10) << std::fixed << std::setprecision(2)
+              << milliseconds << " ms";
+
+    if (misses >= 0) {
+        std::cout << std::setw(14) << misses << " cache misses";
+    }
+    else {
+        std::cout << std::setw(14) << "n/a" << " cache misses";
+    }
+
+    std::cout << std::endl;
+}
+
+/*
+ * The processing chain as it was before the row-major Image container: column-major Eigen matrices filled
+ * and read in row order.
+ */
+namespace legacy {
+
+Eigen::MatrixXf rgbToGray(const std::vector<uint8_t>& rawImage, const size_t width, const size_t height) {
+    Eigen::MatrixXf I(height, width);
+
+    for (size_t i = 0; i < height; ++i) {
+        for (size_t j = 0; j < width; ++j) {
+            const size_t idx = (i * width + j) * kBytesPerPixel;
+
+            const float red = rawImage[idx + 0];
+            const float grn = rawImage[idx + 1];
+            const float blu = rawImage[idx + 2];
+
+            I(i, j) = (0.2126f * red + 0.7512f * grn + 0.0722 * blu);
+        }
+    }
+
+    return I;
+}
+
+std::vector<uint8_t> matToImage(const Eigen::MatrixXf& matrix) {
+    std::vector<uint8_t> image(matrix.rows() * matrix.cols() * kBytesPerPixel);
+
+    const float oldMin = matrix.minCoeff();
+    const float oldMax = matrix.maxCoeff();
+    const float valueRange = 255.0f / (oldMax - oldMin);
+
+    for (size_t i = 0; i < (size_t) matrix.rows(); ++i) {
+        for (size_t j = 0; j < (size_t) matrix.cols(); ++j) {
+            const size_t idx = (i * matrix.cols() + j) * kBytesPerPixel;
+            const uint8_t value = static_cast<uint8_t>((matrix(i, j) - oldMin) * valueRange);
+
+            image[idx + 0] = value;
+            image[idx + 1] = value;
+            image[idx + 2] = value;
+        }
+    }
+
+    return image;
+}
+
+Eigen::MatrixXf conv2d(const Eigen::MatrixXf& I, const Eigen::MatrixXf& kernel) {
+    Eigen::MatrixXf O = Eigen::MatrixXf::Zero(I.rows(), I.cols());
+
+    const size_t kernelRows = kernel.rows();
+    const size_t kernelCols = kernel.cols();
+
+    for (size_t i = kernelRows; i < I.rows() - kernelRows; i++) {
+        for (size_t j = kernelCols; j < I.cols() - kernelCols; j++) {
+            Eigen::MatrixXf block = I.block(i, j, kernelRows, kernelCols);
+            O(i, j) = block.cwiseProduct(kernel).sum();
+        }
+    }
+
+    return O;
+}
+
+}
+
+static void benchmarkLayout(const size_t width, const size_t height) {
+    std::cout << "\nLayout: column-major Eigen::MatrixXf vs row-major Image, " << width << " x " << height << std::endl;
+
+    RgbImage rgb(width, height);
+    std::vector<uint8_t> packed(width * height * kBytesPerPixel);
+
+    srand(42);
+    for (size_t i = 0; i < height; ++i) {
+        for (size_t j = 0; j < width * kBytesPerPixel; ++j) {
+            rgb.row(i)[j] = packed[i * width * kBytesPerPixel + j] = static_cast<uint8_t>(rand());
+        }
+    }
+
+    Eigen::MatrixXf sobel(3, 3);
+    sobel << 1, 0, -1, 2, 0, -2, 1, 0, -1;
+
+    Timer timer;
+    CacheMissCounter counter;
+
+    timer.tick(); counter.start();
+    const Eigen::MatrixXf legacyGray = legacy::rgbToGray(packed, width, height);
+    report("rgbToGray (MatrixXf)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    const GrayImage gray = rgbToGray(rgb);
+    report("rgbToGray (Image)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    const Eigen::MatrixXf legacyGx = legacy::conv2d(legacyGray, sobel);
+    report("conv2d 3x3 (MatrixXf)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    const GrayImage gx = conv2d(gray, sobel, kBorderSkip);
+    report("conv2d 3x3 (Image)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    const std::vector<uint8_t> legacyDisplay = legacy::matToImage(legacyGx);
+    report("matToImage (MatrixXf)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    const std::vector<uint8_t> display = matToImage(gx);
+    report("matToImage (Image)", timer.tock(), counter.stop());
+
+    // The legacy conv2d anchors the kernel at its top left corner and leaves a full kernel size margin.
+    float maxError = 0.0f;
+    for (size_t i = 3; i + 3 < height; ++i) {
+        for (size_t j = 3; j + 3 < width; ++j) {
+            maxError = std::max(maxError, std::abs(legacyGx(i, j) - gx(i + 1, j + 1)));
+        }
+    }
+
+    std::cout << "  conv2d max abs difference: " << maxError << std::endl;
+}
+
+static void benchmarkDistanceTransform(const size_t width, const size_t height) {
+    std::cout << "\nEuclidean distance transform, " << width << " x " << height << std::endl;
+
+    // Sparse random edges, about one pixel in a thousand.
+    GrayImage edges(width, height);
+
+    srand(7);
+    for (size_t i = 0; i < height; ++i) {
+        for (size_t j = 0; j < width; ++j) {
+            edges(i, j) = (rand() % 1000 == 0) ? 1.0f : 0.0f;
+        }
+    }
+
+    GrayImage distance;
+    IndexImage nearest;
+
+    Timer timer;
+    CacheMissCounter counter;
+
+    timer.tick(); counter.start();
+    distanceTransform(edges, 0.5f, &distance);
+    report("distanceTransform", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    distanceTransform(edges, 0.5f, &distance, &nearest);
+    report("distanceTransform + nearest index", timer.tock(), counter.stop());
+
+    // Brute force check on a corner of the image.
+    const size_t checkWidth = std::min<size_t>(width, 160);
+    const size_t checkHeight = std::min<size_t>(height, 120);
+
+    GrayImage corner(checkWidth, checkHeight);
+    for (size_t i = 0; i < checkHeight; ++i) {
+        for (size_t j = 0; j < checkWidth; ++j) {
+            corner(i, j) = edges(i, j);
+        }
+    }
+
+    distanceTransform(corner, 0.5f, &distance, &nearest);
+
+    float maxError = 0.0f;
+    size_t badIndices = 0;
+
+    for (size_t i = 0; i < checkHeight; ++i) {
+        for (size_t j = 0; j < checkWidth; ++j) {
+            float best = std::numeric_limits<float>::infinity();
+
+            for (size_t y = 0; y < checkHeight; ++y) {
+                for (size_t x = 0; x < checkWidth; ++x) {
+                    if (corner(y, x) >= 0.5f) {
+                        const float dx = float(x) - float(j);
+                        const float dy = float(y) - float(i);
+                        best = std::min(best, std::sqrt(dx * dx + dy * dy));
+                    }
+                }
+            }
+
+            if (!std::isinf(best)) {
+                maxError = std::max(maxError, std::abs(best - distance(i, j)));
+
+                const int32_t index = nearest(i, j);
+                const float dx = float(index % checkWidth) - float(j);
+                const float dy = float(index / checkWidth) - float(i);
+
+                if (index < 0 || std::abs(std::sqrt(dx * dx + dy * dy) - best) > 1E-3f) {
+                    ++badIndices;
+                }
+            }
+        }
+    }
+
+    std::cout << "  brute force max abs difference: " << maxError << ", wrong nearest indices: " << badIndices << std::endl;
+}
+
+/*
+ * Packed RGB to luma for every implementation the CPU supports, against a plain memcpy of the same pixels as
+ * the bandwidth ceiling. Every implementation must agree with the scalar one exactly; returns false if not.
+ */
+static bool benchmarkLuma(const size_t width, const size_t height) {
+    const size_t pixels = width * height;
+
+    std::cout << "\nRGB24 to luma, " << width << " x " << height << ", detected " << simdLevelName(detectSimdLevel()) << std::endl;
+
+    std::vector<uint8_t> rgb(pixels * kBytesPerPixel);
+    std::vector<uint8_t> copy(rgb.size());
+
+    srand(11);
+    for (size_t i = 0; i < rgb.size(); ++i) {
+        rgb[i] = static_cast<uint8_t>(rand());
+    }
+
+    // Bytes read plus bytes written, per millisecond, in GB/s.
+    const auto bandwidth = [](const size_t bytes, const double milliseconds) {
+        return bytes / (milliseconds * 1E6);
+    };
+
+    Timer timer;
+
+    timer.tick();
+    memcpy(copy.data(), rgb.data(), rgb.size());
+    const double copyTime = timer.tock();
+    std::cout << "  " << std::left << std::setw(36) << "memcpy" << std::right << std::setw(10) << std::fixed << std::setprecision(2)
+              << copyTime << " ms" << std::setw(10) << bandwidth(2 * rgb.size(), copyTime) << " GB/s" << std::endl;
+
+    std::vector<float> referenceFloat(pixels);
+    std::vector<uint8_t> referenceByte(pixels);
+    std::vector<float> lumaFloat(pixels);
+    std::vector<uint8_t> lumaByte(pixels);
+
+    bool agree = true;
+
+    for (int level = kSimdScalar; level <= detectSimdLevel(); ++level) {
+        const SimdLevel simd = static_cast<SimdLevel>(level);
+        float* floatOut = (simd == kSimdScalar) ? referenceFloat.data() : lumaFloat.data();
+        uint8_t* byteOut = (simd == kSimdScalar) ? referenceByte.data() : lumaByte.data();
+
+        // One call per row of the benchmark image, the way rgbToGray() uses it.
+        timer.tick();
+        for (size_t i = 0; i < height; ++i) {
+            rgbToLumaRow(rgb.data() + i * width * kBytesPerPixel, width, floatOut + i * width, simd);
+        }
+        const double floatTime = timer.tock();
+
+        timer.tick();
+        for (size_t i = 0; i < height; ++i) {
+            rgbToLumaRow(rgb.data() + i * width * kBytesPerPixel, width, byteOut + i * width, simd);
+        }
+        const double byteTime = timer.tock();
+
+        const std::string name = simdLevelName(simd);
+
+        std::cout << "  " << std::left << std::setw(36) << (name + " -> float") << std::right << std::setw(10) << floatTime << " ms"
+                  << std::setw(10) << bandwidth(pixels * (kBytesPerPixel + sizeof(float)), floatTime) << " GB/s" << std::endl;
+        std::cout << "  " << std::left << std::setw(36) << (name + " -> uint8") << std::right << std::setw(10) << byteTime << " ms"
+                  << std::setw(10) << bandwidth(pixels * (kBytesPerPixel + 1), byteTime) << " GB/s" << std::endl;
+
+        if (simd != kSimdScalar) {
+            float maxError = 0.0f;
+            size_t byteMismatches = 0;
+
+            for (size_t k = 0; k < pixels; ++k) {
+                maxError = std::max(maxError, std::abs(lumaFloat[k] - referenceFloat[k]));
+                byteMismatches += (lumaByte[k] != referenceByte[k]);
+            }
+
+            std::cout << "  " << name << " vs scalar: float max abs difference " << maxError << ", uint8 mismatches " << byteMismatches
+                      << std::endl;
+
+            agree = agree && maxError == 0.0f && byteMismatches == 0;
+        }
+    }
+
+    // Widths that leave every possible tail length after the vector loops, on the saturation edge cases.
+    const uint8_t extremes[] = { 0, 1, 127, 128, 254, 255 };
+
+    for (size_t tailWidth = 1; tailWidth <= 67; ++tailWidth) {
+        std::vector<uint8_t> row(tailWidth * kBytesPerPixel);
+
+        for (size_t k = 0; k < row.size(); ++k) {
+            row[k] = extremes[(k * 7 + tailWidth) % 6];
+        }
+
+        std::vector<float> expectedFloat(tailWidth), actualFloat(tailWidth);
+        std::vector<uint8_t> expectedByte(tailWidth), actualByte(tailWidth);
+
+        rgbToLumaRow(row.data(), tailWidth, expectedFloat.data(), kSimdScalar);
+        rgbToLumaRow(row.data(), tailWidth, expectedByte.data(), kSimdScalar);
+        rgbToLumaRow(row.data(), tailWidth, actualFloat.data());
+        rgbToLumaRow(row.data(), tailWidth, actualByte.data());
+
+        if (expectedFloat != actualFloat || expectedByte != actualByte) {
+            std::cout << "  row tail mismatch at width " << tailWidth << std::endl;
+            agree = false;
+        }
+    }
+
+    return agree;
+}
+
+/*
+ * Brute force correlation of a small image with a kernel under a border mode, the reference for the
+ * fixed-size convolutions. Returns the largest difference relative to the output range.
+ */
+template <int K>
+static float kernelError(const GrayImage& I, const Kernel<K>& kernel, const BorderMode border, const GrayImage& O) {
+    const int radius = K / 2;
+    const ptrdiff_t rows = I.height();
+    const ptrdiff_t cols = I.width();
+
+    float maxError = 0.0f;
+    float range = 1E-6f;
+
+    for (ptrdiff_t i = 0; i < rows; ++i) {
+        for (ptrdiff_t j = 0; j < cols; ++j) {
+            const bool skipped = (border == kBorderSkip) && (i < radius || j < radius || i >= rows - radius || j >= cols - radius);
+            double expected = 0.0;
+
+            for (int a = 0; a < K && !skipped; ++a) {
+                for (int b = 0; b < K; ++b) {
+                    const ptrdiff_t y = borderIndex(i + a - radius, rows, border);
+                    const ptrdiff_t x = borderIndex(j + b - radius, cols, border);
+
+                    if (y >= 0 && x >= 0) {
+                        expected += kernel(a, b) * I(y, x);
+                    }
+                }
+            }
+
+            maxError = std::max(maxError, static_cast<float>(std::abs(expected - O(i, j))));
+            range = std::max(range, static_cast<float>(std::abs(expected)));
+        }
+    }
+
+    return maxError / range;
+}
+
+template <int K>
+static bool checkKernel(const std::string& name, const GrayImage& I, const SeparableKernel<K>& kernel) {
+    const BorderMode borders[] = { kBorderSkip, kBorderZero, kBorderReplicate, kBorderReflect };
+    const char* borderNames[] = { "skip", "zero", "replicate", "reflect" };
+
+    bool agree = true;
+
+    const Eigen::MatrixXf runtimeKernel = kernel.dense();
+
+    for (int m = 0; m < 4; ++m) {
+        const float denseError = kernelError(I, kernel.dense(), borders[m], conv2d(I, kernel.dense(), borders[m]));
+        const float separableError = kernelError(I, kernel.dense(), borders[m], conv2d(I, kernel, borders[m]));
+        const float directError = kernelError(I, kernel.dense(), borders[m], conv2dDirect(I, runtimeKernel, borders[m]));
+        const float fftError = kernelError(I, kernel.dense(), borders[m], conv2dFft(I, runtimeKernel, borders[m]));
+
+        if (denseError > 1E-5f || separableError > 1E-5f || directError > 1E-5f || fftError > 1E-5f) {
+            std::cout << "  " << name << " " << borderNames[m] << ": relative error dense " << denseError << ", separable "
+                      << separableError << ", runtime direct " << directError << ", runtime FFT " << fftError << std::endl;
+            agree = false;
+        }
+    }
+
+    return agree;
+}
+
+/*
+ * Runtime sized kernels against the fixed-size dense and separable ones, and every version against brute
+ * force in every border mode.
+ */
+static bool benchmarkKernels(const size_t width, const size_t height) {
+    std::cout << "\nFixed-size kernels, " << width << " x " << height << std::endl;
+
+    GrayImage gray(width, height);
+
+    srand(5);
+    for (size_t i = 0; i < height; ++i) {
+        for (size_t j = 0; j < width; ++j) {
+            gray(i, j) = static_cast<float>(rand() % 256);
+        }
+    }
+
+    Timer timer;
+    CacheMissCounter counter;
+
+    timer.tick(); counter.start();
+    const GrayImage dynamicSobel = conv2d(gray, Eigen::MatrixXf(sobelX().dense()), kBorderSkip);
+    report("Sobel 3x3 (MatrixXf)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    const GrayImage denseSobel = conv2d(gray, sobelX().dense(), kBorderSkip);
+    report("Sobel 3x3 (Kernel<3>)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    const GrayImage separableSobel = conv2d(gray, sobelX(), kBorderSkip);
+    report("Sobel 3x3 (separable)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    conv2d(gray, sobelX(), kBorderReplicate);
+    report("Sobel 3x3 (separable, replicate)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    conv2d(gray, Eigen::MatrixXf(gaussian<7>().dense()), kBorderSkip);
+    report("Gaussian 7x7 (MatrixXf)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    conv2d(gray, gaussian<7>().dense(), kBorderSkip);
+    report("Gaussian 7x7 (Kernel<7>)", timer.tock(), counter.stop());
+
+    timer.tick(); counter.start();
+    conv2d(gray, gaussian<7>(), kBorderSkip);
+    report("Gaussian 7x7 (separable)", timer.tock(), counter.stop());
+
+    float runtimeError = 0.0f;
+
+    for (size_t i = 0; i < height; ++i) {
+        for (size_t j = 0; j < width; ++j) {
+            runtimeError = std::max(runtimeError, std::abs(dynamicSobel(i, j) - denseSobel(i, j)));
+            runtimeError = std::max(runtimeError, std::abs(dynamicSobel(i, j) - separableSobel(i, j)));
+        }
+    }
+
+    std::cout << "  MatrixXf vs fixed-size max abs difference: " << runtimeError << std::endl;
+
+    // Every kernel and border mode against brute force, on an image small enough to brute force.
+    GrayImage small(61, 47);
+
+    for (size_t i = 0; i < small.height(); ++i) {
+        for (size_t j = 0; j < small.width(); ++j) {
+            small(i, j) = gray(i, j);
+        }
+    }
+
+    bool agree = runtimeError < 1E-3f;
+
+    agree = checkKernel("sobelX", small, sobelX()) && agree;
+    agree = checkKernel("sobelY", small, sobelY()) && agree;
+    agree = checkKernel("scharrX", small, scharrX()) && agree;
+    agree = checkKernel("prewittY", small, prewittY()) && agree;
+    agree = checkKernel("box<5>", small, box<5>()) && agree;
+    agree = checkKernel("gaussian<3>", small, gaussian<3>()) && agree;
+    agree = checkKernel("gaussian<5>", small, gaussian<5>()) && agree;
+    agree = checkKernel("gaussian<7>", small, gaussian<7>()) && agree;
+
+    const BorderMode borders[] = { kBorderSkip, kBorderZero, kBorderReplicate, kBorderReflect };
+
+    for (int m = 0; m < 4; ++m) {
+        const float error = kernelError(small, laplacian(), borders[m], conv2d(small, laplacian(), borders[m]));
+
+        if (error > 1E-5f) {
+            std::cout << "  laplacian border mode " << m << ": relative error " << error << std::endl;
+            agree = false;
+        }
+    }
+
+    std::cout << "  kernels vs brute force in every border mode: " << (agree ? "agree" : "DISAGREE") << std::endl;
+
+    return agree;
+}
+
+/*
+ * Direct against FFT convolution over a range of square kernel sizes, on a crop of at most 2000 x 1500 so the
+ * large direct kernels finish. Reports where the FFT starts winning, which is what kFftKernelTaps is set
+ * from, and fails when the two disagree by more than float rounding.
+ */
+static bool benchmarkFftCrossover(const size_t width, const size_t height) {
+    const size_t cropWidth  = std::min<size_t>(width, 2000);
+    const size_t cropHeight = std::min<size_t>(height, 1500);
+
+    std::cout << "\nDirect vs FFT convolution, " << cropWidth << " x " << cropHeight << std::endl;
+
+    GrayImage gray(cropWidth, cropHeight);
+
+    srand(3);
+    for (size_t i = 0; i < cropHeight; ++i) {
+        for (size_t j = 0; j < cropWidth; ++j) {
+            gray(i, j) = static_cast<float>(rand() % 256);
+        }
+    }
+
+    const size_t sizes[] = { 3, 5, 7, 9, 11, 13, 15, 21, 31, 41 };
+
+    Timer timer;
+    size_t crossover = 0;
+    bool agree = true;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        const size_t k = sizes[s];
+
+        if (cropWidth <= 2 * k || cropHeight <= 2 * k) {
+            break;
+        }
+
+        Eigen::MatrixXf kernel(k, k);
+        for (size_t a = 0; a < k; ++a) {
+            for (size_t b = 0; b < k; ++b) {
+                kernel(a, b) = static_cast<float>(rand() % 17) - 8.0f;
+            }
+        }
+
+        timer.tick();
+        const GrayImage direct = conv2dDirect(gray, kernel);
+        const double directTime = timer.tock();
+
+        timer.tick();
+        const GrayImage fft = conv2dFft(gray, kernel);
+        const double fftTime = timer.tock();
+
+        float maxError = 0.0f;
+        float range = 1E-6f;
+
+        for (size_t i = 0; i < cropHeight; ++i) {
+            for (size_t j = 0; j < cropWidth; ++j) {
+                maxError = std::max(maxError, std::abs(direct(i, j) - fft(i, j)));
+                range = std::max(range, std::abs(direct(i, j)));
+            }
+        }
+
+        std::cout << "  " << std::setw(2) << k << " x " << std::setw(2) << k << ": direct " << std::setw(10) << directTime << " ms, FFT "
+                  << std::setw(10) << fftTime << " ms (n = " << fftTileSize(k, k) << "), relative difference " << std::scientific
+                  << maxError / range << std::fixed << std::endl;
+
+        if (crossover == 0 && fftTime < directTime) {
+            crossover = k;
+        }
+
+        agree = agree && maxError / range < 1E-4f;
+    }
+
+    if (crossover > 0) {
+        std::cout << "  FFT is faster from " << crossover << " x " << crossover << " on this machine (conv2d switches at "
+                  << kFftKernelTaps << " taps)" << std::endl;
+    }
+
+    return agree;
+}
+
+int main(int argc, char** argv) {
+    size_t width    = kDefaultBenchmarkWidth;
+    size_t height   = kDefaultBenchmarkHeight;
+
+    if (argc >= 3) {
+        width   = std::strtoul(argv[1], NULL, 10);
+        height  = std::strtoul(argv[2], NULL, 10);
+    }
+
+    const bool lumaAgrees = benchmarkLuma(width, height);
+    benchmarkLayout(width, height);
+    const bool kernelsAgree = benchmarkKernels(width, height);
+    const bool fftAgrees = benchmarkFftCrossover(width, height);
+    benchmarkDistanceTransform(width, height);
+
+    return (lumaAgrees && kernelsAgree && fftAgrees) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
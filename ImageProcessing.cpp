@@ -0,0 +1,186 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ImageProcessing.cpp
+ *
+ * The following implements the image processing chain used by the viewer: gray
+ * conversion, convolution and edge maps.
+ *
+ ****************************************************************************
+ */
+
+#include "ColorConversion.hpp"
+#include "FftConvolution.hpp"
+#include "ImageProcessing.hpp"
+#include "ImageStats.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+// Rows handed to a thread at a time, small images stay on one thread.
+const size_t kMinChunkRows = 64;
+
+GrayImage rgbToGray(const RgbImage& rawImage) {
+    const size_t width  = rawImage.width();
+    const size_t height = rawImage.height();
+
+    GrayImage I(width, height);
+
+    parallelFor(0, height, [&](const size_t rowBegin, const size_t rowEnd, const size_t) {
+        for (size_t i = rowBegin; i < rowEnd; ++i) {
+            rgbToLumaRow(rawImage.row(i), width, I.row(i));
+        }
+    }, kMinChunkRows);
+
+    return I;
+}
+
+std::vector<uint8_t> matToImage(const GrayImage& matrix) {
+    std::vector<uint16_t> keys;
+    const ImageStats stats = computeImageStats(matrix, &keys);
+
+    std::cout << "oldMin, oldMax: " << stats.min << ", " << stats.max << std::endl;
+
+    return applyDisplayLut(keys, buildDisplayLut(fullRangeWindow(stats)), kBytesPerPixel);
+}
+
+GrayImage computeEdgeMap(const GrayImage& I, const bool useConvolution, const BorderMode border) {
+    const size_t rows = I.height();
+    const size_t cols = I.width();
+
+    GrayImage Gx;
+    GrayImage Gy;
+
+    if (useConvolution) {
+        Gx = conv2d(I, sobelX(), border);
+        Gy = conv2d(I, sobelY(), border);
+    }
+    else {
+        // Forward differences, the last column of Gx and the last row of Gy stay zero.
+        Gx.resize(cols, rows);
+        Gy.resize(cols, rows);
+
+        for (size_t i = 0; i < rows; ++i) {
+            const float* src = I.row(i);
+            const float* below = I.row(std::min(i + 1, rows - 1));
+            float* gx = Gx.row(i);
+            float* gy = Gy.row(i);
+
+            for (size_t j = 0; j + 1 < cols; ++j) {
+                gx[j] = src[j + 1] - src[j];
+            }
+
+            if (i + 1 < rows) {
+                for (size_t j = 0; j < cols; ++j) {
+                    gy[j] = below[j] - src[j];
+                }
+            }
+        }
+    }
+
+    GrayImage edgeMap(cols, rows);
+    edgeMap.map() = (Gx.map().array().square() + Gy.map().array().square()).sqrt().matrix();
+
+    return edgeMap;
+}
+
+GrayImage conv2d(const GrayImage& I, const Eigen::MatrixXf& kernel, const BorderMode border) {
+    if (static_cast<size_t>(kernel.size()) >= kFftKernelTaps) {
+        return conv2dFft(I, kernel, border);
+    }
+
+    return conv2dDirect(I, kernel, border);
+}
+
+/*
+ * Correlates I with the kernel centred on each output pixel. The image is padded once by the kernel size so
+ * the inner loop reads both operands contiguously.
+ */
+GrayImage conv2dDirect(const GrayImage& I, const Eigen::MatrixXf& kernel, const BorderMode border) {
+    const size_t rows = I.height();
+    const size_t cols = I.width();
+
+    GrayImage O(cols, rows);
+
+    const size_t kernelRows = kernel.rows();
+    const size_t kernelCols = kernel.cols();
+
+    if (rows == 0 || cols == 0 || kernelRows == 0 || kernelCols == 0) {
+        return O;
+    }
+
+    const size_t top    = kernelRows / 2;
+    const size_t left   = kernelCols / 2;
+    const size_t bottom = kernelRows - 1 - top;
+    const size_t right  = kernelCols - 1 - left;
+
+    const GrayImage P = padImage(I, top, bottom, left, right, border);
+
+    // Row-major copy of the kernel.
+    std::vector<float> weights(kernelRows * kernelCols);
+
+    for (size_t a = 0; a < kernelRows; ++a) {
+        for (size_t b = 0; b < kernelCols; ++b) {
+            weights[a * kernelCols + b] = kernel(a, b);
+        }
+    }
+
+    parallelFor(0, rows, [&](const size_t rowBegin, const size_t rowEnd, const size_t) {
+        for (size_t i = rowBegin; i < rowEnd; ++i) {
+            float* dst = O.row(i);
+
+            for (size_t j = 0; j < cols; ++j) {
+                float sum = 0.0f;
+
+                for (size_t a = 0; a < kernelRows; ++a) {
+                    const float* src = P.row(i + a) + j;
+                    const float* w = &weights[a * kernelCols];
+
+                    for (size_t b = 0; b < kernelCols; ++b) {
+                        sum += src[b] * w[b];
+                    }
+                }
+
+                dst[j] = sum;
+            }
+        }
+    }, kMinChunkRows);
+
+    if (border == kBorderSkip) {
+        clearBorder(&O, top, bottom, left, right);
+    }
+
+    return O;
+}
@@ -0,0 +1,74 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ImageProcessing.hpp
+ *
+ * The following implements the image processing chain used by the viewer: gray
+ * conversion, convolution and edge maps. Everything here works on the row-major
+ * Image container and has no dependency on wxWidgets or OpenGL.
+ *
+ ****************************************************************************
+ */
+
+#ifndef IMAGE_PROCESSING_HPP
+#define IMAGE_PROCESSING_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "Convolution.hpp"
+#include "Image.hpp"
+
+const size_t kBytesPerPixel = 3;
+
+GrayImage rgbToGray(const RgbImage& rawImage);
+std::vector<uint8_t> matToImage(const GrayImage& matrix);
+// Border handling of the Sobel edge map, shared by the in-memory and the streamed pipelines.
+const BorderMode kEdgeMapBorder = kBorderReplicate;
+
+GrayImage computeEdgeMap(const GrayImage& grayImage, const bool useConvolution = true, const BorderMode border = kEdgeMapBorder);
+
+// Kernels with at least this many taps go through the FFT, see the crossover in ImageBenchmark.
+const size_t kFftKernelTaps = 9 * 9;
+
+/*
+ * Kernels of any size known only at runtime, with the same meaning as the fixed-size conv2d() in
+ * Convolution.hpp: the kernel centred on the output pixel (at rows / 2, cols / 2), applied without
+ * normalization, and pixels outside the image read as the border mode says. conv2d() picks the direct loop
+ * or the FFT by kernel size.
+ */
+GrayImage conv2d(const GrayImage& I, const Eigen::MatrixXf& kernel, const BorderMode border = kBorderReplicate);
+GrayImage conv2dDirect(const GrayImage& I, const Eigen::MatrixXf& kernel, const BorderMode border = kBorderReplicate);
+
+#endif
@@ -0,0 +1,226 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ImageStats.cpp
+ *
+ * The following implements single pass image statistics (min, max, mean and a
+ * histogram) and LUT based display windowing of floating point image data.
+ *
+ ****************************************************************************
+ */
+
+#include "ImageStats.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Keeps small images on a single thread, a private histogram per chunk is 256 KB.
+const size_t kStatsMinChunkPixels = 1 << 18;
+
+float ImageStats::percentile(const float p) const {
+    if (count == 0 || histogram.empty()) {
+        return 0.0f;
+    }
+
+    const float clamped = std::min(std::max(p, 0.0f), 100.0f);
+    const uint64_t target = static_cast<uint64_t>(std::ceil(clamped / 100.0f * count));
+
+    uint64_t cumulative = 0;
+
+    for (size_t key = 0; key < histogram.size(); ++key) {
+        cumulative += histogram[key];
+
+        if (cumulative >= target && histogram[key] > 0) {
+            const float value = keyToFloat(static_cast<uint16_t>(key));
+            return std::min(std::max(value, min), max);
+        }
+    }
+
+    return max;
+}
+
+ImageStats computeImageStats(const GrayImage& matrix, std::vector<uint16_t>* keys) {
+    const size_t rows = matrix.height();
+    const size_t cols = matrix.width();
+
+    ImageStats stats;
+    stats.count = rows * cols;
+    stats.histogram.assign(kHistogramBins, 0);
+
+    if (stats.count == 0) {
+        stats.min = stats.max = stats.mean = 0.0f;
+        return stats;
+    }
+
+    if (keys) {
+        keys->resize(stats.count);
+    }
+
+    const size_t minChunkRows = std::max<size_t>(1, kStatsMinChunkPixels / std::max<size_t>(1, cols));
+    const size_t chunks = parallelChunkCount(rows, minChunkRows);
+
+    std::vector<float>      chunkMin(chunks, std::numeric_limits<float>::max());
+    std::vector<float>      chunkMax(chunks, -std::numeric_limits<float>::max());
+    std::vector<double>     chunkSum(chunks, 0.0);
+    std::vector<std::vector<uint32_t> > chunkHistogram(chunks);
+
+    parallelFor(0, rows, [&](const size_t rowBegin, const size_t rowEnd, const size_t chunk) {
+        std::vector<uint32_t>& histogram = chunkHistogram[chunk];
+        histogram.assign(kHistogramBins, 0);
+
+        float   localMin = chunkMin[chunk];
+        float   localMax = chunkMax[chunk];
+        double  localSum = 0.0;
+
+        for (size_t i = rowBegin; i < rowEnd; ++i) {
+            const float* row = matrix.row(i);
+            uint16_t* rowKeys = keys ? (keys->data() + i * cols) : NULL;
+            double rowSum = 0.0;
+
+            for (size_t j = 0; j < cols; ++j) {
+                const float value = row[j];
+                const uint16_t key = floatToKey(value);
+
+                localMin = std::min(localMin, value);
+                localMax = std::max(localMax, value);
+                rowSum += value;
+
+                ++histogram[key];
+
+                if (rowKeys) {
+                    rowKeys[j] = key;
+                }
+            }
+
+            localSum += rowSum;
+        }
+
+        chunkMin[chunk] = localMin;
+        chunkMax[chunk] = localMax;
+        chunkSum[chunk] = localSum;
+    }, minChunkRows);
+
+    double sum = 0.0;
+    stats.min = chunkMin[0];
+    stats.max = chunkMax[0];
+
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        stats.min = std::min(stats.min, chunkMin[chunk]);
+        stats.max = std::max(stats.max, chunkMax[chunk]);
+        sum += chunkSum[chunk];
+
+        const std::vector<uint32_t>& histogram = chunkHistogram[chunk];
+
+        for (size_t key = 0; key < histogram.size(); ++key) {
+            stats.histogram[key] += histogram[key];
+        }
+    }
+
+    stats.mean = static_cast<float>(sum / stats.count);
+
+    return stats;
+}
+
+DisplayWindow fullRangeWindow(const ImageStats& stats, const float gamma) {
+    DisplayWindow window;
+    window.low      = stats.min;
+    window.high     = stats.max;
+    window.gamma    = gamma;
+
+    return window;
+}
+
+DisplayWindow percentileWindow(const ImageStats& stats, const float lowPercent, const float highPercent, const float gamma) {
+    DisplayWindow window;
+    window.low      = stats.percentile(lowPercent);
+    window.high     = stats.percentile(highPercent);
+    window.gamma    = gamma;
+
+    return window;
+}
+
+std::vector<uint8_t> buildDisplayLut(const DisplayWindow& window) {
+    std::vector<uint8_t> lut(kHistogramBins);
+
+    const float range = window.high - window.low;
+    const float scale = (range > 0.0f) ? (1.0f / range) : 0.0f;
+    const float exponent = (window.gamma > 0.0f) ? (1.0f / window.gamma) : 1.0f;
+
+    for (size_t key = 0; key < kHistogramBins; ++key) {
+        const float value = keyToFloat(static_cast<uint16_t>(key));
+
+        float t = (value - window.low) * scale;
+
+        // NaN keys compare false everywhere and end up black.
+        if (!(t > 0.0f)) {
+            t = 0.0f;
+        }
+        else if (t > 1.0f) {
+            t = 1.0f;
+        }
+
+        if (exponent != 1.0f) {
+            t = std::pow(t, exponent);
+        }
+
+        lut[key] = static_cast<uint8_t>(t * 255.0f + 0.5f);
+    }
+
+    // A flat window (constant image) shows everything at or above it as white.
+    if (range <= 0.0f) {
+        for (size_t key = floatToKey(window.high); key < kHistogramBins; ++key) {
+            lut[key] = 255;
+        }
+    }
+
+    return lut;
+}
+
+std::vector<uint8_t> applyDisplayLut(const std::vector<uint16_t>& keys, const std::vector<uint8_t>& lut, const size_t channels) {
+    std::vector<uint8_t> image(keys.size() * channels);
+
+    parallelFor(0, keys.size(), [&](const size_t begin, const size_t end, const size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            const uint8_t value = lut[keys[i]];
+
+            for (size_t c = 0; c < channels; ++c) {
+                image[i * channels + c] = value;
+            }
+        }
+    }, kStatsMinChunkPixels);
+
+    return image;
+}
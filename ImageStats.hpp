@@ -0,0 +1,111 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ImageStats.hpp
+ *
+ * The following implements single pass image statistics (min, max, mean and a
+ * histogram) and LUT based display windowing of floating point image data.
+ * 
+ * Every float is reduced to an order preserving 16 bit key while the statistics
+ * are gathered, so changing the display window only rebuilds a 65536 entry LUT
+ * and reapplies it to the keys; the float data is never revisited.
+ *
+ ****************************************************************************
+ */
+
+#ifndef IMAGE_STATS_HPP
+#define IMAGE_STATS_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Image.hpp"
+
+const size_t kHistogramBins = 65536;
+
+struct ImageStats {
+    float                   min;
+    float                   max;
+    float                   mean;
+    size_t                  count;
+
+    // Indexed by floatToKey(), so bin k covers every float whose key is k.
+    std::vector<uint32_t>   histogram;
+
+    float percentile(const float p) const;
+};
+
+struct DisplayWindow {
+    float low;
+    float high;
+    float gamma;
+};
+
+/*
+ * Maps a float onto the upper 16 bits of its IEEE representation, flipped so that unsigned key order matches
+ * float order (the same trick used by radix sorts). The key keeps the sign, the exponent and 7 bits of mantissa.
+ */
+inline uint16_t floatToKey(const float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+/*
+ * Returns the float in the middle of the range of values that share the given key.
+ */
+inline float keyToFloat(const uint16_t key) {
+    uint32_t bits = (static_cast<uint32_t>(key) << 16) | 0x8000u;
+
+    bits = (bits & 0x80000000u) ? (bits & 0x7FFFFFFFu) : ~bits;
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+ImageStats computeImageStats(const GrayImage& matrix, std::vector<uint16_t>* keys = NULL);
+
+DisplayWindow fullRangeWindow(const ImageStats& stats, const float gamma = 1.0f);
+DisplayWindow percentileWindow(const ImageStats& stats, const float lowPercent, const float highPercent, const float gamma = 1.0f);
+
+std::vector<uint8_t> buildDisplayLut(const DisplayWindow& window);
+std::vector<uint8_t> applyDisplayLut(const std::vector<uint16_t>& keys, const std::vector<uint8_t>& lut, const size_t channels = 3);
+
+#endif
@@ -44,47 +44,231 @@
 
 #include "ImageViewer.hpp"
 
+#include <cstring>
+#include <iomanip>
+
 class MyApp: public wxApp {
     virtual bool OnInit();
 
-    wxFrame*        frame;
-    BasicGLPane*    glPane;
+    ImageViewerFrame*   frame;
     
     public:
 
 };
 
-IMPLEMENT_APP(MyApp)
+IMPLEMENT_APP_NO_MAIN(MyApp)
+
+// Options only the headless modes read; the viewer skips them.
+static const char* const kHeadlessOptions[] = { "--strip-rows=", "--thumbnail-size=", "--thumbnail-cache=" };
+
+static bool isHeadlessOption(const std::string& arg) {
+    for (size_t k = 0; k < sizeof(kHeadlessOptions) / sizeof(kHeadlessOptions[0]); ++k) {
+        if (arg.compare(0, strlen(kHeadlessOptions[k]), kHeadlessOptions[k]) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
 
+/*
+ *        ImageViewer --stream <input> <output.tiles> [--strip-rows=N] runs the edge map pipeline out of core
+ * without opening a window; the resulting .tiles file can then be opened like any other image.
+ *
+ *        ImageViewer --thumbnails <folder> <sheet.png> [--thumbnail-size=N] [--thumbnail-cache=DIR] writes a
+ * contact sheet of the folder without opening a window. An empty cache directory disables the cache.
+ *
+ * Both run here, before wxEntry(), so they never touch the GUI toolkit and work without a display.
+ */
+int main(int argc, char** argv) {
+    std::string streamInput;
+    std::string streamOutput;
+    size_t stripRows = kDefaultStripRows;
+
+    std::string thumbnailFolder;
+    std::string contactSheet;
+    size_t thumbnailSize = kDefaultThumbnailSize;
+    std::string thumbnailCache = ThumbnailCache::defaultDirectory();
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const std::string stripRowsOption = "--strip-rows=";
+        const std::string thumbnailSizeOption = "--thumbnail-size=";
+        const std::string thumbnailCacheOption = "--thumbnail-cache=";
+
+        if (arg == "--stream" && i + 2 < argc) {
+            streamInput = argv[++i];
+            streamOutput = argv[++i];
+        }
+        else if (arg.compare(0, stripRowsOption.size(), stripRowsOption) == 0) {
+            stripRows = std::max<size_t>(1, std::strtoul(arg.c_str() + stripRowsOption.size(), NULL, 10));
+        }
+        else if (arg == "--thumbnails" && i + 2 < argc) {
+            thumbnailFolder = argv[++i];
+            contactSheet = argv[++i];
+        }
+        else if (arg.compare(0, thumbnailSizeOption.size(), thumbnailSizeOption) == 0) {
+            thumbnailSize = std::max<size_t>(16, std::strtoul(arg.c_str() + thumbnailSizeOption.size(), NULL, 10));
+        }
+        else if (arg.compare(0, thumbnailCacheOption.size(), thumbnailCacheOption) == 0) {
+            thumbnailCache = arg.substr(thumbnailCacheOption.size());
+        }
+    }
 
+    if (!streamInput.empty()) {
+        return streamEdgeMap(streamInput, streamOutput, stripRows) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (!thumbnailFolder.empty()) {
+        return writeContactSheet(thumbnailFolder, contactSheet, thumbnailSize, thumbnailCache) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    return wxEntry(argc, argv);
+}
+
+/*
+ * Usage: ImageViewer [--budget-mb=N] [image ...]. Every image opens in its own tab, with ferret.jpg as the
+ * default. The budget caps the CPU and texture memory held by all documents together.
+ *
+ *        --prefetch-processed builds the processed view on a worker thread as soon as an image is shown, and
+ * --eager-processed builds it before the first frame; by default it is built the first time F1 asks for it.
+ */
 bool MyApp::OnInit() {
-    wxBoxSizer* sizer = new wxBoxSizer(wxHORIZONTAL);
-    frame = new wxFrame((wxFrame *) NULL, -1,  wxT("Snake Viewer"), wxPoint(50, 50), wxSize(kDefaultWindowWidth, kDefaultWindowHeight));
-    
-    int args[] = {WX_GL_RGBA, WX_GL_DOUBLEBUFFER, WX_GL_DEPTH_SIZE, 16, 0};
-    
-    glPane  = new BasicGLPane((wxFrame *) frame, "ferret.jpg", args);
+    std::vector<wxString> fileNames;
+
+    ProcessedChannel processedChannel = kProcessedOnDemand;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = wxString(argv[i]).ToStdString();
+        const std::string budgetOption = "--budget-mb=";
+
+        if (arg.compare(0, budgetOption.size(), budgetOption) == 0) {
+            const size_t budget = std::strtoul(arg.c_str() + budgetOption.size(), NULL, 10) * kMegabyte;
+            ResidencyManager::instance().setBudget(budget);
+
+            std::cout << "MyApp::OnInit(): residency budget: " << budget / kMegabyte << " MB." << std::endl;
+        }
+        else if (arg == "--prefetch-processed") {
+            processedChannel = kProcessedPrefetch;
+        }
+        else if (arg == "--eager-processed") {
+            processedChannel = kProcessedEager;
+        }
+        else if (!isHeadlessOption(arg)) {
+            fileNames.push_back(wxString(argv[i]));
+        }
+    }
+
+    if (fileNames.empty()) {
+        fileNames.push_back(wxT("ferret.jpg"));
+    }
+
+    frame = new ImageViewerFrame(wxT("Snake Viewer"), processedChannel);
+
+    for (size_t i = 0; i < fileNames.size(); ++i) {
+        frame->openDocument(fileNames[i]);
+    }
+
     frame->Show();
     
     return true;
 }
 
-BasicGLPane::BasicGLPane(wxFrame* parent, const char* fileName, int* args) :
+ImageViewerFrame::ImageViewerFrame(const wxString& title, const ProcessedChannel processedChannel) :
+    wxFrame((wxFrame *) NULL, -1, title, wxPoint(50, 50), wxSize(kDefaultWindowWidth, kDefaultWindowHeight)) {
+
+    wxMenu* fileMenu = new wxMenu();
+    fileMenu->Append(wxID_OPEN, wxT("&Open...\tCtrl+O"));
+    fileMenu->AppendSeparator();
+    fileMenu->Append(wxID_EXIT, wxT("E&xit"));
+
+    wxMenuBar* menuBar = new wxMenuBar();
+    menuBar->Append(fileMenu, wxT("&File"));
+    SetMenuBar(menuBar);
+
+    CreateStatusBar();
+
+    m_notebook      = new wxNotebook(this, wxID_ANY);
+    m_shareContext  = NULL;
+
+    m_processedChannel = processedChannel;
+}
+
+void ImageViewerFrame::openDocument(const wxString& fileName) {
+    int args[] = {WX_GL_RGBA, WX_GL_DOUBLEBUFFER, WX_GL_DEPTH_SIZE, 16, 0};
+
+    BasicGLPane* pane = new BasicGLPane(m_notebook, fileName.mb_str(), args, m_shareContext, m_processedChannel);
+
+    if (m_shareContext == NULL) {
+        m_shareContext = pane->context();
+    }
+
+    const size_t separator = fileName.find_last_of("/\\");
+    const wxString title = (separator == wxString::npos) ? fileName : wxString(fileName.substr(separator + 1));
+
+    m_notebook->AddPage(pane, title, true);
+}
+
+void ImageViewerFrame::onOpen(wxCommandEvent& event) {
+    wxFileDialog dialog(this, wxT("Open images"), wxT(""), wxT(""),
+                        wxT("Images (*.jpg;*.jpeg;*.png;*.bmp;*.tif;*.tiff)|*.jpg;*.jpeg;*.png;*.bmp;*.tif;*.tiff|All files (*.*)|*.*"),
+                        wxFD_OPEN | wxFD_FILE_MUST_EXIST | wxFD_MULTIPLE);
+
+    if (dialog.ShowModal() == wxID_CANCEL) {
+        return;
+    }
+
+    wxArrayString paths;
+    dialog.GetPaths(paths);
+
+    for (size_t i = 0; i < paths.GetCount(); ++i) {
+        openDocument(paths[i]);
+    }
+}
+
+void ImageViewerFrame::onExit(wxCommandEvent& event) {
+    Close(true);
+}
+
+BEGIN_EVENT_TABLE(ImageViewerFrame, wxFrame)
+    EVT_MENU(wxID_OPEN, ImageViewerFrame::onOpen)
+    EVT_MENU(wxID_EXIT, ImageViewerFrame::onExit)
+END_EVENT_TABLE()
+
+BasicGLPane::BasicGLPane(wxWindow* parent, const char* fileName, int* args, const wxGLContext* shareContext,
+                         const ProcessedChannel processedChannel) :
     wxGLCanvas(parent, wxID_ANY, args, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE) {
 
-    m_context = new wxGLContext(this);
+    m_firstFrameShown = false;
+    m_firstProcessedFrameShown = false;
+
+    m_context = new wxGLContext(this, shareContext);
     
     // TODO: introduce some logic around the filename to test it before attempting to load
     m_imageFileName = std::string(fileName);
     m_drawableImage = NULL;
+    m_processedChannel = processedChannel;
 
     // To avoid flashing on MSW
     SetBackgroundStyle(wxBG_STYLE_CUSTOM);
 
     m_showProcessed = false;
+
+    m_windowPreset  = 0;
+    m_gamma         = 1.0f;
+
+    m_snake                 = NULL;
+    m_dragId                = kNoSnaxel;
+    m_statsIteration        = 0;
+    m_iterationsPerSecond   = 0.0;
+    m_snapshotLatency       = 0.0;
+
+    m_snakeTimer.SetOwner(this, ID_SNAKE_TIMER);
 }
 
 BasicGLPane::~BasicGLPane() {
+    stopSnake();
+
     if (m_context) {
         delete m_context;
     }
@@ -94,6 +278,10 @@ BasicGLPane::~BasicGLPane() {
     }
 }
 
+wxGLContext* BasicGLPane::context() {
+    return m_context;
+}
+
 void BasicGLPane::resized(wxSizeEvent& evt) {
     //wxGLCanvas::OnSize(evt);
 
@@ -127,9 +315,17 @@ void BasicGLPane::render(wxPaintEvent& evt) {
 
     // If the image has not been loaded yet, go ahead and load it.
     if (m_drawableImage == NULL) {
-        m_drawableImage = new DrawableImage(m_imageFileName.c_str());
+        m_startupTimer.tick();
+        m_drawableImage = new DrawableImage(m_imageFileName.c_str(), m_processedChannel);
     }
 
+    // A finished prefetch is adopted before the budget is checked, so it is counted rather than held aside.
+    m_drawableImage->collectPrefetch();
+
+    // This pane is the active document now; anything evicted here is rebuilt lazily when its tab is shown.
+    ResidencyManager::instance().touch(m_drawableImage);
+    ResidencyManager::instance().enforceBudget();
+
     wxPaintDC(this); // only to be used in paint events. use wxClientDC to paint outside the paint event
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -137,45 +333,334 @@ void BasicGLPane::render(wxPaintEvent& evt) {
     // ------------- draw some 2D ----------------
     prepare2DViewport(0, 0, getWidth(), getHeight());
    
-    const float scaleX = (float) getWidth() / (float) m_drawableImage->width();
-    const float scaleY = (float) getHeight() / (float) m_drawableImage->height();;
+    const ViewRect& view = m_drawableImage->view();
+    const float scaleX = (float) getWidth() / view.width;
+    const float scaleY = (float) getHeight() / view.height;
 
     m_drawableImage->scale(scaleX, scaleY);
     
+    Timer processedTimer;
+    processedTimer.tick();
+
     if (m_showProcessed) {
         m_drawableImage->renderProcessedData();
     }
     else {
         m_drawableImage->renderRawData();
     }
+
+    const double processedLatency = processedTimer.tock();
+
+    if (m_snake) {
+        pollSnake();
+        renderSnake();
+    }
     
     glFlush();
     SwapBuffers();
+
+    if (!m_firstFrameShown) {
+        m_firstFrameShown = true;
+
+        static const char* const channelNames[] = { "on demand", "prefetch", "eager" };
+
+        std::cout << "BasicGLPane::render(): time to first frame: " << m_startupTimer.tock() << " ms, processed channel "
+                  << channelNames[m_processedChannel] << "." << std::endl;
+    }
+
+    if (m_showProcessed && !m_firstProcessedFrameShown) {
+        m_firstProcessedFrameShown = true;
+
+        std::cout << "BasicGLPane::render(): first processed frame: " << processedLatency << " ms to build and draw." << std::endl;
+    }
+
+    // An evicted document that is shown again starts rebuilding its processed view straight away.
+    if (m_processedChannel == kProcessedPrefetch) {
+        m_drawableImage->prefetchProcessed();
+    }
+
+    updateStatusBar();
+}
+
+void BasicGLPane::updateStatusBar() {
+    wxFrame* frame = dynamic_cast<wxFrame*>(wxGetTopLevelParent(this));
+
+    if (frame == NULL || frame->GetStatusBar() == NULL) {
+        return;
+    }
+
+    const ResidencyManager& residency = ResidencyManager::instance();
+
+    std::ostringstream status;
+    status << "Documents: " << residency.documentCount()
+           << "   CPU: " << residency.cpuBytes() / kMegabyte << " MB"
+           << "   GPU: " << residency.textureBytes() / kMegabyte << " MB"
+           << "   Budget: " << residency.budget() / kMegabyte << " MB";
+
+    if (m_drawableImage && m_drawableImage->sourceLost()) {
+        status << "   Source file changed or missing, cannot rebuild";
+    }
+
+    if (m_snake) {
+        status << "   Snake: " << m_snake->snapshot().snaxels.size() << " snaxels, "
+               << static_cast<int>(m_iterationsPerSecond) << " it/s, "
+               << m_snapshotLatency << " ms snapshot latency";
+    }
+
+    frame->SetStatusText(status.str());
+}
+
+
+void BasicGLPane::startSnake() {
+    if (m_snake || m_drawableImage == NULL) {
+        return;
+    }
+
+    // The image only keeps weak references to its maps. Hold the edge map first so the distance map is built
+    // from it rather than from a second decode of the source.
+    const std::shared_ptr<const GrayImage> edges = m_drawableImage->edgeMap();
+    if (!edges) {
+        return;
+    }
+
+    const std::shared_ptr<const GrayImage> distance = m_drawableImage->distanceMap();
+
+    m_snake = new SnakeSolver(edges, distance);
+    m_snake->start();
+
+    m_statsIteration = 0;
+    m_statsTimer.tick();
+
+    m_snakeTimer.Start(kSnakeRefreshInterval);
 }
 
+void BasicGLPane::stopSnake() {
+    m_snakeTimer.Stop();
+
+    if (m_snake) {
+        delete m_snake;
+        m_snake = NULL;
+    }
+
+    m_dragId = kNoSnaxel;
+}
+
+/*
+ * Picks up the solver's latest contour, if there is a new one, and updates the iteration rate and the
+ * publish-to-paint latency shown in the status bar. Never blocks on the solver.
+ */
+bool BasicGLPane::pollSnake() {
+    const bool updated = m_snake->update();
+    const ContourSnapshot& snapshot = m_snake->snapshot();
+
+    if (updated) {
+        const std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - snapshot.published;
+        m_snapshotLatency = latency.count();
+    }
+
+    const double elapsed = m_statsTimer.tock();
+
+    if (elapsed >= kSnakeStatsInterval) {
+        m_iterationsPerSecond = (snapshot.iteration - m_statsIteration) * 1000.0 / elapsed;
+        m_statsIteration = snapshot.iteration;
+        m_statsTimer.tick();
+    }
+
+    return updated;
+}
+
+/*
+ * Draws the contour in image coordinates on top of whichever channel is shown.
+ */
+void BasicGLPane::renderSnake() {
+    const std::vector<snaxel>& snaxels = m_snake->snapshot().snaxels;
+
+    if (snaxels.empty()) {
+        return;
+    }
+
+    const ViewRect& view = m_drawableImage->view();
+
+    glLoadIdentity();
+    glScalef((float) getWidth() / view.width, (float) getHeight() / view.height, 1.0f);
+    glTranslatef(-view.x, -view.y, 0.0f);
+
+    glDisable(GL_TEXTURE_2D);
+    glColor3f(0.0f, 1.0f, 0.0f);
+
+    glBegin(GL_LINE_LOOP);
+    for (size_t i = 0; i < snaxels.size(); ++i) {
+        glVertex2f(snaxels[i].x + 0.5f, snaxels[i].y + 0.5f);
+    }
+    glEnd();
+
+    glPointSize(5.0f);
+    glColor3f(1.0f, 1.0f, 0.0f);
+
+    glBegin(GL_POINTS);
+    for (size_t i = 0; i < snaxels.size(); ++i) {
+        glVertex2f(snaxels[i].x + 0.5f, snaxels[i].y + 0.5f);
+    }
+    glEnd();
+
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glEnable(GL_TEXTURE_2D);
+}
+
+bool BasicGLPane::screenToImage(const wxPoint& point, snaxel* position) {
+    if (m_drawableImage == NULL || point.x < 0 || point.y < 0 || getWidth() <= 0 || getHeight() <= 0) {
+        return false;
+    }
+
+    const ViewRect& view = m_drawableImage->view();
+
+    const size_t x = (size_t) (view.x + point.x * view.width / getWidth());
+    const size_t y = (size_t) (view.y + point.y * view.height / getHeight());
+
+    if (x >= m_drawableImage->width() || y >= m_drawableImage->height()) {
+        return false;
+    }
+
+    position->x = x;
+    position->y = y;
+
+    return true;
+}
+
+/*
+ * Returns the id of the snaxel closest to the point within kSnaxelPickRadius screen pixels, or kNoSnaxel.
+ * The id stays valid while edits queued after this snapshot add or remove other snaxels.
+ */
+uint32_t BasicGLPane::pickSnaxel(const wxPoint& point) {
+    if (m_snake == NULL) {
+        return kNoSnaxel;
+    }
+
+    const std::vector<snaxel>& snaxels = m_snake->snapshot().snaxels;
+    const std::vector<uint32_t>& ids = m_snake->snapshot().ids;
+
+    const ViewRect& view = m_drawableImage->view();
+    const float scaleX = (float) getWidth() / view.width;
+    const float scaleY = (float) getHeight() / view.height;
+
+    uint32_t best = kNoSnaxel;
+    float bestDistance = kSnaxelPickRadius * kSnaxelPickRadius;
+
+    for (size_t i = 0; i < snaxels.size(); ++i) {
+        const float dx = (snaxels[i].x + 0.5f - view.x) * scaleX - point.x;
+        const float dy = (snaxels[i].y + 0.5f - view.y) * scaleY - point.y;
+        const float distance = dx * dx + dy * dy;
+
+        if (distance <= bestDistance) {
+            bestDistance = distance;
+            best = ids[i];
+        }
+    }
+
+    return best;
+}
+
+void BasicGLPane::editSnake(const SnakeEdit::Type type, const uint32_t id, const snaxel& position) {
+    SnakeEdit edit;
+    edit.type       = type;
+    edit.id         = id;
+    edit.position   = position;
+
+    if (!m_snake->edit(edit)) {
+        std::cout << "BasicGLPane::editSnake(): the edit queue is full, dropping the edit." << std::endl;
+    }
+}
+
+void BasicGLPane::snakeTimer(wxTimerEvent& event) {
+    if (m_snake && IsShownOnScreen()) {
+        Refresh(false);
+    }
+}
 
 // some useful events to use
 void BasicGLPane::mouseMoved(wxMouseEvent& event) {
+    snaxel position;
 
+    if (m_dragId == kNoSnaxel || !event.LeftIsDown() || !screenToImage(event.GetPosition(), &position)) {
+        return;
+    }
+
+    editSnake(SnakeEdit::Move, m_dragId, position);
 }
 
+/*
+ * A click on a snaxel grabs it, anywhere else adds a new one to the contour.
+ */
 void BasicGLPane::mouseDown(wxMouseEvent& event) {
     const int xPos = event.GetPosition().x;
     const int yPos = event.GetPosition().y;
 
     std::cout << "BasicGLPane::mouseDown(): x,y: " << xPos << ", " << yPos << "." << std::endl;    
+
+    snaxel position;
+
+    if (!screenToImage(event.GetPosition(), &position)) {
+        return;
+    }
+
+    startSnake();
+
+    if (m_snake == NULL) {
+        updateStatusBar();
+        return;
+    }
+
+    m_dragId = pickSnaxel(event.GetPosition());
+
+    if (m_dragId != kNoSnaxel) {
+        editSnake(SnakeEdit::Move, m_dragId, position);
+        CaptureMouse();
+    }
+    else {
+        editSnake(SnakeEdit::Add, kNoSnaxel, position);
+    }
 }
 
+/*
+ * The wheel zooms about the point under the cursor. Tiled images page in full resolution tiles once zoomed
+ * in far enough.
+ */
 void BasicGLPane::mouseWheelMoved(wxMouseEvent& event) {
-    
+    if (m_drawableImage == NULL || event.GetWheelRotation() == 0 || getWidth() <= 0 || getHeight() <= 0) {
+        return;
+    }
+
+    const ViewRect& view = m_drawableImage->view();
+    const float x = view.x + event.GetPosition().x * view.width / getWidth();
+    const float y = view.y + event.GetPosition().y * view.height / getHeight();
+
+    m_drawableImage->zoom((event.GetWheelRotation() > 0) ? kZoomStep : 1.0f / kZoomStep, x, y);
+
+    Refresh(false);
 }
 
 void BasicGLPane::mouseReleased(wxMouseEvent& event) {
-    
+    if (m_dragId == kNoSnaxel) {
+        return;
+    }
+
+    editSnake(SnakeEdit::Release, m_dragId, snaxel());
+    m_dragId = kNoSnaxel;
+
+    if (HasCapture()) {
+        ReleaseMouse();
+    }
 }
 
+/*
+ * Right clicking a snaxel removes it.
+ */
 void BasicGLPane::rightClick(wxMouseEvent& event) {
-    
+    const uint32_t id = pickSnaxel(event.GetPosition());
+
+    if (id != kNoSnaxel) {
+        editSnake(SnakeEdit::Remove, id, snaxel());
+    }
 }
 
 void BasicGLPane::mouseLeftWindow(wxMouseEvent& event) {
@@ -197,6 +682,72 @@ void BasicGLPane::keyPressed(wxKeyEvent& event) {
         wxPaintEvent paintEvent;
         render(paintEvent);
     }
+    else if (event.GetKeyCode() == WXK_F2) {
+        m_windowPreset = (m_windowPreset + 1) % kWindowPresetCount;
+
+        std::cout << "\nImageViewer::keyPressed(): display window set to the " << kWindowPresets[m_windowPreset][0]
+                  << " - " << kWindowPresets[m_windowPreset][1] << " percentiles" << std::endl;
+
+        updateDisplayWindow();
+
+        wxPaintEvent paintEvent;
+        render(paintEvent);
+    }
+    else if (event.GetKeyCode() == WXK_F3) {
+        if (m_drawableImage == NULL) {
+            return;
+        }
+
+        std::vector<BufferBytes> buffers;
+        m_drawableImage->memoryUsage(&buffers);
+
+        std::cout << "\nImageViewer::keyPressed(): memory held by this image:" << std::endl;
+
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            std::cout << "    " << std::left << std::setw(20) << buffers[i].name << std::right << std::setw(12) << buffers[i].bytes
+                      << " bytes" << (buffers[i].texture ? " (texture)" : "") << std::endl;
+        }
+
+        std::cout << "    CPU " << m_drawableImage->cpuBytes() << " bytes, textures " << m_drawableImage->textureBytes() << " bytes"
+                  << std::endl;
+    }
+    else if (event.GetKeyCode() == WXK_ESCAPE && m_snake) {
+        std::cout << "\nImageViewer::keyPressed(): clearing the snake" << std::endl;
+
+        if (HasCapture()) {
+            ReleaseMouse();
+        }
+
+        m_dragId = kNoSnaxel;
+        editSnake(SnakeEdit::Clear, kNoSnaxel, snaxel());
+    }
+    else if (event.GetKeyCode() == WXK_UP || event.GetKeyCode() == WXK_DOWN) {
+        m_gamma = (event.GetKeyCode() == WXK_UP) ? (m_gamma * kGammaStep) : (m_gamma / kGammaStep);
+
+        std::cout << "\nImageViewer::keyPressed(): display gamma set to " << m_gamma << std::endl;
+
+        updateDisplayWindow();
+
+        wxPaintEvent paintEvent;
+        render(paintEvent);
+    }
+}
+
+/*
+ * Pushes the current window preset and gamma to the image. The statistics were cached when the edge map was
+ * built so this never goes back to the float data.
+ */
+void BasicGLPane::updateDisplayWindow() {
+    if (m_drawableImage == NULL) {
+        return;
+    }
+
+    wxGLCanvas::SetCurrent(*m_context);
+
+    const ImageStats& stats = m_drawableImage->edgeStats();
+    const float* preset = kWindowPresets[m_windowPreset];
+
+    m_drawableImage->setDisplayWindow(percentileWindow(stats, preset[0], preset[1], m_gamma));
 }
 
 void BasicGLPane::keyReleased(wxKeyEvent& event) {
@@ -214,6 +765,7 @@ BEGIN_EVENT_TABLE(BasicGLPane, wxGLCanvas)
     EVT_KEY_UP(BasicGLPane::keyReleased)
     EVT_MOUSEWHEEL(BasicGLPane::mouseWheelMoved)
     EVT_PAINT(BasicGLPane::render)
+    EVT_TIMER(ID_SNAKE_TIMER, BasicGLPane::snakeTimer)
 END_EVENT_TABLE()
 
 int BasicGLPane::getWidth() {
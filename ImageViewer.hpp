@@ -55,8 +55,12 @@
 #endif
 
 #include <string>
+#include <sstream>
 
 #include "DrawableImage.hpp"
+#include "Snake.hpp"
+#include "StreamingPipeline.hpp"
+#include "Thumbnails.hpp"
 
 #include <wx/wx.h>
 #include <wx/sizer.h>
@@ -66,6 +70,14 @@
 const size_t kDefaultWindowWidth    = 1024;
 const size_t kDefaultWindowHeight   = 768;
 
+// Display window presets cycled with F2, as {low, high} percentiles of the processed data.
+const size_t kWindowPresetCount     = 3;
+const float  kWindowPresets[kWindowPresetCount][2] = { {0.0f, 100.0f}, {1.0f, 99.0f}, {5.0f, 95.0f} };
+const float  kGammaStep             = 1.1f;
+
+// Each mouse wheel notch zooms the view in or out by this factor.
+const float  kZoomStep              = 1.25f;
+
 //const size_t kDefaultWindowWidth    = 2048;
 //const size_t kDefaultWindowHeight   = 1536;
 
@@ -73,19 +85,65 @@ const size_t kDefaultWindowHeight   = 768;
 //const size_t kDefaultWindowWidth  = 0.75 * wxSystemSettings::GetMetric(wxSYS_SCREEN_X);
 //const size_t kDefaultWindowHeight = 0.75 * wxSystemSettings::GetMetric(wxSYS_SCREEN_Y);
 
+const size_t kMegabyte              = 1024 * 1024;
+
+// Snake editing: how close (in screen pixels) a click must be to grab a snaxel, and how often the pane
+// repaints while the solver is running.
+const int    kSnaxelPickRadius      = 8;
+const int    kSnakeRefreshInterval  = 33;
+const double kSnakeStatsInterval    = 500.0;
+
+enum {
+    ID_SNAKE_TIMER = wxID_HIGHEST + 1
+};
+
 class BasicGLPane : public wxGLCanvas {
     private:
         wxGLContext*    m_context;
         std::string     m_imageFileName;
         
         DrawableImage*  m_drawableImage;
+        ProcessedChannel    m_processedChannel;
 
         bool            m_showProcessed;
 
+        // Startup report: time from loading the document, on its first render, to its first frame, and the
+        // cost of its first processed frame. A tab opened in the background starts its clock when first shown.
+        Timer           m_startupTimer;
+        bool            m_firstFrameShown;
+        bool            m_firstProcessedFrameShown;
+
+        size_t          m_windowPreset;
+        float           m_gamma;
+
+        // Snake editing. The solver runs on its own thread; the pane only ever reads its latest snapshot.
+        SnakeSolver*    m_snake;
+        wxTimer         m_snakeTimer;
+        uint32_t        m_dragId;
+
+        uint64_t        m_statsIteration;
+        Timer           m_statsTimer;
+        double          m_iterationsPerSecond;
+        double          m_snapshotLatency;
+
+        void updateDisplayWindow();
+        void updateStatusBar();
+
+        void startSnake();
+        void stopSnake();
+        bool pollSnake();
+        void renderSnake();
+        bool screenToImage(const wxPoint& point, snaxel* position);
+        uint32_t pickSnaxel(const wxPoint& point);
+        void editSnake(const SnakeEdit::Type type, const uint32_t id, const snaxel& position);
+
     public:
-        BasicGLPane(wxFrame* parent, const char* fileName, int* args);
+        BasicGLPane(wxWindow* parent, const char* fileName, int* args, const wxGLContext* shareContext = NULL,
+                    const ProcessedChannel processedChannel = kProcessedOnDemand);
         virtual ~BasicGLPane();
 
+        wxGLContext* context();
+
         void resized(wxSizeEvent& evt);
 
         int getWidth();
@@ -103,6 +161,28 @@ class BasicGLPane : public wxGLCanvas {
         void mouseLeftWindow(wxMouseEvent& event);
         void keyPressed(wxKeyEvent& event);
         void keyReleased(wxKeyEvent& event);
+        void snakeTimer(wxTimerEvent& event);
+
+        DECLARE_EVENT_TABLE()
+};
+
+/*
+ * The main window. Every open document is a BasicGLPane on its own notebook page; all panes share GL objects
+ * with the first one so the residency manager can release any document's textures from the active pane.
+ */
+class ImageViewerFrame : public wxFrame {
+    private:
+        wxNotebook*     m_notebook;
+        wxGLContext*    m_shareContext;
+        ProcessedChannel    m_processedChannel;
+
+    public:
+        ImageViewerFrame(const wxString& title, const ProcessedChannel processedChannel = kProcessedOnDemand);
+
+        void openDocument(const wxString& fileName);
+
+        void onOpen(wxCommandEvent& event);
+        void onExit(wxCommandEvent& event);
 
         DECLARE_EVENT_TABLE()
 };
@@ -0,0 +1,126 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Kernels.hpp
+ *
+ * The following implements a library of fixed-size convolution kernels. Kernel
+ * sizes are compile time constants so the convolution loops over them unroll, and
+ * kernels that factor into a column and a row vector are kept in that form.
+ *
+ ****************************************************************************
+ */
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#define EIGEN_MPL2_ONLY
+#include <Eigen/Eigen>
+
+template <int K>
+using Kernel = Eigen::Matrix<float, K, K, Eigen::RowMajor>;
+
+/*
+ * A kernel equal to column * row^T: column weights the K rows around the output pixel, row weights the K
+ * columns. Applying it costs 2K multiply-adds per pixel instead of K^2.
+ */
+template <int K>
+struct SeparableKernel {
+    Eigen::Matrix<float, K, 1> column;
+    Eigen::Matrix<float, K, 1> row;
+
+    Kernel<K> dense() const {
+        return column * row.transpose();
+    }
+};
+
+template <int K>
+SeparableKernel<K> separableKernel(const float (&column)[K], const float (&row)[K]) {
+    SeparableKernel<K> kernel;
+
+    for (int k = 0; k < K; ++k) {
+        kernel.column(k) = column[k];
+        kernel.row(k) = row[k];
+    }
+
+    return kernel;
+}
+
+/*
+ * Derivative kernels. X kernels respond to intensity decreasing left to right, Y kernels to intensity
+ * decreasing top to bottom, matching the kernels the edge map has always used.
+ */
+inline SeparableKernel<3> sobelX()      { const float c[] = { 1,  2, 1 }, r[] = { 1, 0, -1 }; return separableKernel(c, r); }
+inline SeparableKernel<3> sobelY()      { const float c[] = { 1,  0, -1 }, r[] = { 1, 2, 1 }; return separableKernel(c, r); }
+inline SeparableKernel<3> scharrX()     { const float c[] = { 3, 10, 3 }, r[] = { 1, 0, -1 }; return separableKernel(c, r); }
+inline SeparableKernel<3> scharrY()     { const float c[] = { 1,  0, -1 }, r[] = { 3, 10, 3 }; return separableKernel(c, r); }
+inline SeparableKernel<3> prewittX()    { const float c[] = { 1,  1, 1 }, r[] = { 1, 0, -1 }; return separableKernel(c, r); }
+inline SeparableKernel<3> prewittY()    { const float c[] = { 1,  0, -1 }, r[] = { 1, 1, 1 }; return separableKernel(c, r); }
+
+inline Kernel<3> laplacian() {
+    Kernel<3> kernel;
+    kernel << 0,  1, 0,
+              1, -4, 1,
+              0,  1, 0;
+    return kernel;
+}
+
+// Smoothing kernels, normalized to sum to one.
+template <int K>
+SeparableKernel<K> box() {
+    SeparableKernel<K> kernel;
+    kernel.column.setConstant(1.0f / K);
+    kernel.row.setConstant(1.0f / K);
+    return kernel;
+}
+
+// Binomial approximation of a Gaussian, sigma about sqrt(K - 1) / 2. The weights are exact in float.
+template <int K>
+SeparableKernel<K> gaussian() {
+    static_assert(K == 3 || K == 5 || K == 7, "gaussian() is defined for K = 3, 5 and 7");
+
+    SeparableKernel<K> kernel;
+
+    // Row K - 1 of Pascal's triangle.
+    kernel.column(0) = 1.0f;
+    for (int k = 1; k < K; ++k) {
+        kernel.column(k) = kernel.column(k - 1) * (K - k) / k;
+    }
+
+    kernel.column /= kernel.column.sum();
+    kernel.row = kernel.column;
+
+    return kernel;
+}
+
+#endif
@@ -0,0 +1,141 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: LockFree.hpp
+ *
+ * The following implements the lock-free primitives used to hand data between
+ * the snake solver thread and the GUI thread: a triple buffer for publishing
+ * snapshots and a bounded single producer / single consumer queue for edits.
+ *
+ ****************************************************************************
+ */
+
+#ifndef LOCK_FREE_HPP
+#define LOCK_FREE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * One writer fills back() and calls publish(); one reader calls update() and then reads front(). Neither
+ * side ever waits: the writer always has a free buffer, and the reader always sees the latest complete
+ * publish (intermediate ones are dropped).
+ */
+template <typename T>
+class TripleBuffer {
+    private:
+        // Set on the middle index while it holds a publish the reader has not picked up yet.
+        static const uint8_t    kFresh = 0x4;
+        static const uint8_t    kIndexMask = 0x3;
+
+        T                       m_buffers[3];
+
+        std::atomic<uint8_t>    m_middle;
+        uint8_t                 m_back;     // owned by the writer
+        uint8_t                 m_front;    // owned by the reader
+
+    public:
+        TripleBuffer() : m_middle(1), m_back(0), m_front(2) { }
+
+        T& back() {
+            return m_buffers[m_back];
+        }
+
+        void publish() {
+            const uint8_t old = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel);
+            m_back = old & kIndexMask;
+        }
+
+        // Returns true when front() changed since the last call.
+        bool update() {
+            if ((m_middle.load(std::memory_order_relaxed) & kFresh) == 0) {
+                return false;
+            }
+
+            const uint8_t old = m_middle.exchange(m_front, std::memory_order_acq_rel);
+            m_front = old & kIndexMask;
+
+            return true;
+        }
+
+        const T& front() const {
+            return m_buffers[m_front];
+        }
+};
+
+/*
+ * Bounded ring buffer for exactly one producer thread and one consumer thread. push() fails instead of
+ * blocking when the queue is full.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    private:
+        T                       m_items[Capacity];
+
+        std::atomic<size_t>     m_head;     // next slot to pop, written by the consumer
+        std::atomic<size_t>     m_tail;     // next slot to push, written by the producer
+
+    public:
+        SpscQueue() : m_head(0), m_tail(0) { }
+
+        bool push(const T& item) {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            const size_t next = (tail + 1) % Capacity;
+
+            if (next == m_head.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            m_items[tail] = item;
+            m_tail.store(next, std::memory_order_release);
+
+            return true;
+        }
+
+        bool pop(T* item) {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+
+            if (head == m_tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            *item = m_items[head];
+            m_head.store((head + 1) % Capacity, std::memory_order_release);
+
+            return true;
+        }
+};
+
+#endif
@@ -0,0 +1,100 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Parallel.hpp
+ *
+ * The following implements a minimal fork/join helper for splitting a range of
+ * work across the available cores.
+ *
+ ****************************************************************************
+ */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/*
+ * Returns the number of chunks parallelFor() splits a range of the given length into. Callers that keep
+ * per-chunk accumulators (histograms, partial sums, ...) size them with this.
+ */
+inline size_t parallelChunkCount(const size_t length, const size_t minChunkLength = 1) {
+    size_t threads = std::thread::hardware_concurrency();
+
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    const size_t maxChunks = std::max<size_t>(1, length / std::max<size_t>(1, minChunkLength));
+
+    return std::min(threads, maxChunks);
+}
+
+/*
+ * Calls function(chunkBegin, chunkEnd, chunkIndex) for contiguous chunks of [begin, end), one chunk per
+ * thread. The calling thread works on chunk 0 and blocks until every chunk is done.
+ */
+template <typename Function>
+void parallelFor(const size_t begin, const size_t end, Function function, const size_t minChunkLength = 1) {
+    if (end <= begin) {
+        return;
+    }
+
+    const size_t length         = end - begin;
+    const size_t chunks         = parallelChunkCount(length, minChunkLength);
+    const size_t chunkLength    = (length + chunks - 1) / chunks;
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks);
+
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        const size_t chunkBegin = begin + chunk * chunkLength;
+        const size_t chunkEnd   = std::min(end, chunkBegin + chunkLength);
+
+        if (chunkBegin < chunkEnd) {
+            workers.emplace_back(function, chunkBegin, chunkEnd, chunk);
+        }
+    }
+
+    function(begin, std::min(end, begin + chunkLength), static_cast<size_t>(0));
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+}
+
+#endif
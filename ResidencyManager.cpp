@@ -0,0 +1,129 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ResidencyManager.cpp
+ *
+ * The following implements a global residency manager that tracks the CPU and
+ * texture memory held by every open document and evicts the least recently
+ * used inactive documents when the total goes over a configurable budget.
+ *
+ ****************************************************************************
+ */
+
+#include "ResidencyManager.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+ResidencyManager::ResidencyManager() {
+    m_budget = kDefaultResidencyBudget;
+}
+
+ResidencyManager& ResidencyManager::instance() {
+    static ResidencyManager manager;
+    return manager;
+}
+
+void ResidencyManager::setBudget(const size_t bytes) {
+    m_budget = bytes;
+}
+
+size_t ResidencyManager::budget() const {
+    return m_budget;
+}
+
+void ResidencyManager::add(ResidentDocument* document) {
+    remove(document);
+    m_documents.push_back(document);
+}
+
+void ResidencyManager::remove(ResidentDocument* document) {
+    m_documents.remove(document);
+}
+
+void ResidencyManager::touch(ResidentDocument* document) {
+    std::list<ResidentDocument*>::iterator it = std::find(m_documents.begin(), m_documents.end(), document);
+
+    if (it != m_documents.end()) {
+        m_documents.splice(m_documents.begin(), m_documents, it);
+    }
+    else {
+        m_documents.push_front(document);
+    }
+}
+
+void ResidencyManager::enforceBudget() {
+    size_t total = cpuBytes() + textureBytes();
+
+    if (total <= m_budget || m_documents.size() < 2) {
+        return;
+    }
+
+    std::list<ResidentDocument*>::reverse_iterator it = m_documents.rbegin();
+    const std::list<ResidentDocument*>::reverse_iterator active = --m_documents.rend();
+
+    for (; it != active && total > m_budget; ++it) {
+        const size_t before = (*it)->cpuBytes() + (*it)->textureBytes();
+        (*it)->evict();
+        const size_t after = (*it)->cpuBytes() + (*it)->textureBytes();
+
+        total -= std::min(total, before - std::min(before, after));
+    }
+
+    std::cout << "ResidencyManager::enforceBudget(): resident bytes: " << total << " of " << m_budget << "." << std::endl;
+}
+
+size_t ResidencyManager::cpuBytes() const {
+    size_t bytes = 0;
+
+    for (std::list<ResidentDocument*>::const_iterator it = m_documents.begin(); it != m_documents.end(); ++it) {
+        bytes += (*it)->cpuBytes();
+    }
+
+    return bytes;
+}
+
+size_t ResidencyManager::textureBytes() const {
+    size_t bytes = 0;
+
+    for (std::list<ResidentDocument*>::const_iterator it = m_documents.begin(); it != m_documents.end(); ++it) {
+        bytes += (*it)->textureBytes();
+    }
+
+    return bytes;
+}
+
+size_t ResidencyManager::documentCount() const {
+    return m_documents.size();
+}
@@ -0,0 +1,118 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ResidencyManager.hpp
+ *
+ * The following implements a global residency manager that tracks the CPU and
+ * texture memory held by every open document and evicts the least recently
+ * used inactive documents when the total goes over a configurable budget.
+ *
+ ****************************************************************************
+ */
+
+#ifndef RESIDENCY_MANAGER_HPP
+#define RESIDENCY_MANAGER_HPP
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <vector>
+
+const size_t kDefaultResidencyBudget = 1024 * 1024 * 1024;
+
+// One buffer or texture held by a document.
+struct BufferBytes {
+    std::string name;
+    size_t      bytes;
+    bool        texture;
+};
+
+/*
+ * Anything that holds image memory the manager is allowed to throw away. evict() must leave the document
+ * able to rebuild what it dropped the next time it is shown.
+ */
+class ResidentDocument {
+    public:
+        virtual ~ResidentDocument() { }
+
+        // Appends every buffer and texture the document currently holds, empty ones included.
+        virtual void    memoryUsage(std::vector<BufferBytes>* buffers) const = 0;
+        virtual void    evict() = 0;
+
+        size_t cpuBytes() const     { return usedBytes(false); }
+        size_t textureBytes() const { return usedBytes(true); }
+
+    private:
+        size_t usedBytes(const bool texture) const {
+            std::vector<BufferBytes> buffers;
+            memoryUsage(&buffers);
+
+            size_t bytes = 0;
+
+            for (size_t i = 0; i < buffers.size(); ++i) {
+                bytes += (buffers[i].texture == texture) ? buffers[i].bytes : 0;
+            }
+
+            return bytes;
+        }
+};
+
+class ResidencyManager {
+    private:
+        // Most recently used first, the front is the active document.
+        std::list<ResidentDocument*>    m_documents;
+        size_t                          m_budget;
+
+        ResidencyManager();
+
+    public:
+        static ResidencyManager& instance();
+
+        void    setBudget(const size_t bytes);
+        size_t  budget() const;
+
+        void    add(ResidentDocument* document);
+        void    remove(ResidentDocument* document);
+        void    touch(ResidentDocument* document);
+
+        // Evicts inactive documents, oldest first, until the total fits the budget. Textures are released
+        // in the GL context that is current when this is called.
+        void    enforceBudget();
+
+        size_t  cpuBytes() const;
+        size_t  textureBytes() const;
+        size_t  documentCount() const;
+};
+
+#endif
@@ -0,0 +1,497 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ScanlineReader.cpp
+ *
+ * The following implements incremental JPEG and PNG decoders that hand out the
+ * image a strip of scanlines at a time.
+ *
+ ****************************************************************************
+ */
+
+#include "ScanlineReader.hpp"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <jpeglib.h>
+#include <png.h>
+
+/*
+ * libjpeg reports fatal errors through error_exit, which must not return; jump back into the reader instead
+ * of letting the default handler exit the process.
+ */
+struct JpegErrorManager {
+    struct jpeg_error_mgr   pub;
+    jmp_buf                 jump;
+};
+
+static void jpegErrorExit(j_common_ptr info) {
+    JpegErrorManager* error = reinterpret_cast<JpegErrorManager*>(info->err);
+
+    (*info->err->output_message)(info);
+    longjmp(error->jump, 1);
+}
+
+class JpegScanlineReader : public ScanlineReader {
+    private:
+        FILE*                           m_file;
+        struct jpeg_decompress_struct   m_info;
+        JpegErrorManager                m_error;
+        bool                            m_created;
+
+    public:
+        JpegScanlineReader() : m_file(NULL), m_created(false) { }
+
+        ~JpegScanlineReader() {
+            if (m_created) {
+                jpeg_destroy_decompress(&m_info);
+            }
+
+            if (m_file) {
+                fclose(m_file);
+            }
+        }
+
+        bool open(const std::string& path, const size_t scaleDenominator) {
+            m_file = fopen(path.c_str(), "rb");
+
+            if (m_file == NULL) {
+                return false;
+            }
+
+            m_info.err = jpeg_std_error(&m_error.pub);
+            m_error.pub.error_exit = jpegErrorExit;
+
+            if (setjmp(m_error.jump)) {
+                return false;
+            }
+
+            jpeg_create_decompress(&m_info);
+            m_created = true;
+
+            jpeg_stdio_src(&m_info, m_file);
+            jpeg_read_header(&m_info, TRUE);
+
+            m_info.out_color_space = JCS_RGB;
+
+            if (scaleDenominator > 1) {
+                // Scaled output is for previews; the fast integer DCT and plain upsampling are good enough.
+                m_info.scale_num            = 1;
+                m_info.scale_denom          = scaleDenominator;
+                m_info.dct_method           = JDCT_IFAST;
+                m_info.do_fancy_upsampling  = FALSE;
+            }
+
+            jpeg_start_decompress(&m_info);
+
+            m_width         = m_info.output_width;
+            m_height        = m_info.output_height;
+            m_fullWidth     = m_info.image_width;
+            m_fullHeight    = m_info.image_height;
+
+            return true;
+        }
+
+        size_t readRows(RgbImage* strip, const size_t count) {
+            if (m_failed) {
+                return 0;
+            }
+
+            if (setjmp(m_error.jump)) {
+                m_failed = true;
+                return 0;
+            }
+
+            size_t produced = 0;
+
+            while (produced < count && m_info.output_scanline < m_info.output_height) {
+                JSAMPROW row = strip->row(produced);
+                produced += jpeg_read_scanlines(&m_info, &row, 1);
+            }
+
+            m_row += produced;
+
+            return produced;
+        }
+};
+
+/*
+ * Scaled decoding reads scale source rows per output row and averages scale x scale blocks; the partial
+ * blocks on the right and bottom edges average the pixels they have.
+ */
+class PngScanlineReader : public ScanlineReader {
+    private:
+        FILE*       m_file;
+        png_structp m_png;
+        png_infop   m_info;
+
+        size_t                  m_scale;
+        bool                    m_firstPassOnly;
+
+        // An interlaced image decoded whole, and the next of its rows to hand out. The row pointers for
+        // png_read_image() are a member too: a decoding error longjmps out of open() past any local.
+        std::vector<uint8_t>    m_buffered;
+        std::vector<png_bytep>  m_bufferedRows;
+        size_t                  m_bufferedRow;
+        size_t                  m_sourceWidth;
+        size_t                  m_sourceHeight;
+        size_t                  m_sourceRow;
+        std::vector<uint8_t>    m_sourceRowBuffer;
+        std::vector<uint32_t>   m_sums;
+
+        // Decodes the next full resolution row into out.
+        void readSourceRow(uint8_t* out) {
+            if (m_buffered.empty()) {
+                png_read_row(m_png, out, NULL);
+                return;
+            }
+
+            const uint8_t* row = m_buffered.data() + m_bufferedRow * m_fullWidth * 3;
+            std::copy(row, row + m_fullWidth * 3, out);
+            ++m_bufferedRow;
+        }
+
+        // Decodes the next output row at scale into out.
+        void readScaledRow(uint8_t* out) {
+            std::fill(m_sums.begin(), m_sums.end(), 0);
+
+            const size_t rows = std::min(m_scale, m_sourceHeight - m_sourceRow);
+
+            for (size_t r = 0; r < rows; ++r) {
+                readSourceRow(m_sourceRowBuffer.data());
+
+                for (size_t x = 0; x < m_sourceWidth; ++x) {
+                    for (size_t c = 0; c < 3; ++c) {
+                        m_sums[(x / m_scale) * 3 + c] += m_sourceRowBuffer[x * 3 + c];
+                    }
+                }
+            }
+
+            m_sourceRow += rows;
+
+            for (size_t j = 0; j < m_width; ++j) {
+                const size_t columns = std::min(m_scale, m_sourceWidth - j * m_scale);
+                const uint32_t count = columns * rows;
+
+                for (size_t c = 0; c < 3; ++c) {
+                    out[j * 3 + c] = static_cast<uint8_t>((m_sums[j * 3 + c] + count / 2) / count);
+                }
+            }
+        }
+
+    public:
+        PngScanlineReader() : m_file(NULL), m_png(NULL), m_info(NULL), m_scale(1), m_firstPassOnly(false), m_bufferedRow(0), m_sourceWidth(0),
+                              m_sourceHeight(0), m_sourceRow(0) { }
+
+        ~PngScanlineReader() {
+            if (m_png) {
+                png_destroy_read_struct(&m_png, m_info ? &m_info : NULL, NULL);
+            }
+
+            if (m_file) {
+                fclose(m_file);
+            }
+        }
+
+        bool open(const std::string& path, const size_t scaleDenominator, const bool bufferInterlaced) {
+            m_file = fopen(path.c_str(), "rb");
+
+            if (m_file == NULL) {
+                return false;
+            }
+
+            m_png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+
+            if (m_png == NULL) {
+                return false;
+            }
+
+            m_info = png_create_info_struct(m_png);
+
+            if (m_info == NULL) {
+                return false;
+            }
+
+            if (setjmp(png_jmpbuf(m_png))) {
+                return false;
+            }
+
+            png_init_io(m_png, m_file);
+            png_read_info(m_png, m_info);
+
+            bool buffered = false;
+
+            if (png_get_interlace_type(m_png, m_info) != PNG_INTERLACE_NONE) {
+                if (scaleDenominator == 8) {
+                    // Without interlace handling libpng hands out the passes in order; the first one holds every
+                    // 8th pixel of every 8th row.
+                    m_firstPassOnly = true;
+                }
+                else if (bufferInterlaced) {
+                    png_set_interlace_handling(m_png);
+                    buffered = true;
+                }
+                else {
+                    std::cout << "PngScanlineReader::open(): " << path << " is interlaced and cannot be streamed." << std::endl;
+                    return false;
+                }
+            }
+
+            const int colorType = png_get_color_type(m_png, m_info);
+            const int bitDepth  = png_get_bit_depth(m_png, m_info);
+
+            // Normalize everything to 8 bit RGB.
+            if (bitDepth == 16) {
+                png_set_strip_16(m_png);
+            }
+
+            if (colorType == PNG_COLOR_TYPE_PALETTE) {
+                png_set_palette_to_rgb(m_png);
+            }
+
+            if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8) {
+                png_set_expand_gray_1_2_4_to_8(m_png);
+            }
+
+            if (colorType & PNG_COLOR_MASK_ALPHA) {
+                png_set_strip_alpha(m_png);
+            }
+
+            if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA) {
+                png_set_gray_to_rgb(m_png);
+            }
+
+            png_read_update_info(m_png, m_info);
+
+            m_fullWidth     = png_get_image_width(m_png, m_info);
+            m_fullHeight    = png_get_image_height(m_png, m_info);
+            m_sourceWidth   = m_fullWidth;
+            m_sourceHeight  = m_fullHeight;
+
+            if (m_firstPassOnly) {
+                m_sourceWidth   = (m_sourceWidth + 7) / 8;
+                m_sourceHeight  = (m_sourceHeight + 7) / 8;
+            }
+            else {
+                m_scale = std::max<size_t>(1, scaleDenominator);
+            }
+
+            m_width     = (m_sourceWidth + m_scale - 1) / m_scale;
+            m_height    = (m_sourceHeight + m_scale - 1) / m_scale;
+
+            if (m_scale > 1) {
+                m_sourceRowBuffer.resize(m_sourceWidth * 3);
+                m_sums.resize(m_width * 3);
+            }
+
+            // libpng writes as many bytes as a full row even for the narrower rows of a pass.
+            if (m_firstPassOnly) {
+                m_sourceRowBuffer.resize(m_fullWidth * 3);
+            }
+
+            if (buffered) {
+                m_buffered.resize(m_fullWidth * m_fullHeight * 3);
+
+                m_bufferedRows.resize(m_fullHeight);
+
+                for (size_t i = 0; i < m_fullHeight; ++i) {
+                    m_bufferedRows[i] = m_buffered.data() + i * m_fullWidth * 3;
+                }
+
+                png_read_image(m_png, m_bufferedRows.data());
+                std::vector<png_bytep>().swap(m_bufferedRows);
+            }
+
+            return true;
+        }
+
+        size_t readRows(RgbImage* strip, const size_t count) {
+            if (m_failed) {
+                return 0;
+            }
+
+            if (setjmp(png_jmpbuf(m_png))) {
+                m_failed = true;
+                return 0;
+            }
+
+            size_t produced = 0;
+
+            while (produced < count && m_row + produced < m_height) {
+                if (m_scale > 1) {
+                    readScaledRow(strip->row(produced));
+                }
+                else if (m_firstPassOnly) {
+                    png_read_row(m_png, m_sourceRowBuffer.data(), NULL);
+                    std::copy(m_sourceRowBuffer.begin(), m_sourceRowBuffer.begin() + m_width * 3, strip->row(produced));
+                }
+                else {
+                    readSourceRow(strip->row(produced));
+                }
+
+                ++produced;
+            }
+
+            m_row += produced;
+
+            return produced;
+        }
+};
+
+enum ImageFormat {
+    kFormatUnknown,
+    kFormatJpeg,
+    kFormatPng
+};
+
+static ImageFormat sniffFormat(const std::string& path) {
+    unsigned char signature[8];
+
+    FILE* file = fopen(path.c_str(), "rb");
+
+    if (file == NULL) {
+        std::cout << "openScanlineReader(): cannot open " << path << "." << std::endl;
+        return kFormatUnknown;
+    }
+
+    const size_t length = fread(signature, 1, sizeof(signature), file);
+    fclose(file);
+
+    if (length >= 3 && signature[0] == 0xFF && signature[1] == 0xD8 && signature[2] == 0xFF) {
+        return kFormatJpeg;
+    }
+
+    if (length == sizeof(signature) && png_sig_cmp(signature, 0, sizeof(signature)) == 0) {
+        return kFormatPng;
+    }
+
+    return kFormatUnknown;
+}
+
+ScanlineReader* openScanlineReader(const std::string& path, const size_t scaleDenominator, const bool bufferInterlaced) {
+    const ImageFormat format = sniffFormat(path);
+
+    if (format == kFormatJpeg) {
+        JpegScanlineReader* reader = new JpegScanlineReader();
+
+        if (reader->open(path, scaleDenominator)) {
+            return reader;
+        }
+
+        delete reader;
+    }
+    else if (format == kFormatPng) {
+        PngScanlineReader* reader = new PngScanlineReader();
+
+        if (reader->open(path, scaleDenominator, bufferInterlaced)) {
+            return reader;
+        }
+
+        delete reader;
+    }
+
+    std::cout << "openScanlineReader(): " << path << " is not a JPEG or PNG that can be streamed." << std::endl;
+
+    return NULL;
+}
+
+static bool readJpegHeader(FILE* file, ImageHeader* header) {
+    struct jpeg_decompress_struct info;
+    JpegErrorManager error;
+
+    info.err = jpeg_std_error(&error.pub);
+    error.pub.error_exit = jpegErrorExit;
+
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_stdio_src(&info, file);
+    jpeg_read_header(&info, TRUE);
+
+    header->width       = info.image_width;
+    header->height      = info.image_height;
+    header->interlaced  = false;
+
+    jpeg_destroy_decompress(&info);
+
+    return true;
+}
+
+static bool readPngHeader(FILE* file, ImageHeader* header) {
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png ? png_create_info_struct(png) : NULL;
+
+    if (info == NULL || setjmp(png_jmpbuf(png))) {
+        png_destroy_read_struct(&png, info ? &info : NULL, NULL);
+        return false;
+    }
+
+    png_init_io(png, file);
+    png_read_info(png, info);
+
+    header->width       = png_get_image_width(png, info);
+    header->height      = png_get_image_height(png, info);
+    header->interlaced  = png_get_interlace_type(png, info) != PNG_INTERLACE_NONE;
+
+    png_destroy_read_struct(&png, &info, NULL);
+
+    return true;
+}
+
+bool readImageHeader(const std::string& path, ImageHeader* header) {
+    const ImageFormat format = sniffFormat(path);
+
+    if (format == kFormatUnknown) {
+        return false;
+    }
+
+    FILE* file = fopen(path.c_str(), "rb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    const bool ok = (format == kFormatJpeg) ? readJpegHeader(file, header) : readPngHeader(file, header);
+
+    fclose(file);
+
+    return ok;
+}
@@ -0,0 +1,108 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: ScanlineReader.hpp
+ *
+ * The following implements incremental JPEG and PNG decoders that hand out the
+ * image a strip of scanlines at a time (through the libjpeg and libpng row
+ * readers), so an image never has to fit in memory as a whole.
+ *
+ ****************************************************************************
+ */
+
+#ifndef SCANLINE_READER_HPP
+#define SCANLINE_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "Image.hpp"
+
+/*
+ * Decodes top to bottom into 8 bit RGB. readRows() fills the next rows of the destination strip and returns
+ * how many it produced, 0 at the end of the image or on a decoding error (see failed()).
+ */
+class ScanlineReader {
+    protected:
+        size_t  m_width;
+        size_t  m_height;
+        size_t  m_fullWidth;
+        size_t  m_fullHeight;
+        size_t  m_row;
+        bool    m_failed;
+
+    public:
+        ScanlineReader() : m_width(0), m_height(0), m_fullWidth(0), m_fullHeight(0), m_row(0), m_failed(false) { }
+        virtual ~ScanlineReader() { }
+
+        // The decoded size, after any scaling.
+        size_t  width() const   { return m_width; }
+        size_t  height() const  { return m_height; }
+
+        // The size of the image in the file.
+        size_t  fullWidth() const   { return m_fullWidth; }
+        size_t  fullHeight() const  { return m_fullHeight; }
+
+        size_t  row() const     { return m_row; }
+        bool    failed() const  { return m_failed; }
+
+        // Fills rows [0, count) of strip, which must be at least width() wide.
+        virtual size_t readRows(RgbImage* strip, const size_t count) = 0;
+};
+
+/*
+ * Opens a JPEG or PNG file based on its signature. Returns NULL if the file cannot be opened or is not a
+ * supported format (interlaced PNGs cannot be decoded a row at a time and are rejected too, unless buffered).
+ *
+ * A scale denominator of 2, 4 or 8 decodes at that fraction of the size, rounded up. JPEGs scale in the DCT
+ * domain and never decode the full resolution; PNGs are box filtered a strip at a time, except interlaced
+ * ones at 1/8, which are read from their first Adam7 pass alone.
+ *
+ * With bufferInterlaced an interlaced PNG opened at any other scale is decoded whole into memory first and
+ * then handed out row by row. Only for callers that know the image is small.
+ */
+ScanlineReader* openScanlineReader(const std::string& path, const size_t scaleDenominator = 1, const bool bufferInterlaced = false);
+
+struct ImageHeader {
+    size_t  width;
+    size_t  height;
+    bool    interlaced;     // Adam7 interlaced PNG
+};
+
+// Reads just the header of a JPEG or PNG file, without starting to decode it.
+bool readImageHeader(const std::string& path, ImageHeader* header);
+
+#endif
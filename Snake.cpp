@@ -0,0 +1,317 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Snake.cpp
+ *
+ * The following implements a greedy active contour (snake) solver that evolves a
+ * closed contour against an edge map on its own thread.
+ *
+ ****************************************************************************
+ */
+
+#include "Snake.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+SnakeSolver::SnakeSolver(const std::shared_ptr<const GrayImage>& edgeMap, const std::shared_ptr<const GrayImage>& distanceMap) :
+    m_edgeMap(edgeMap), m_distanceMap(distanceMap), m_nextId(0), m_iteration(0), m_running(false) {
+}
+
+SnakeSolver::~SnakeSolver() {
+    stop();
+}
+
+void SnakeSolver::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+
+    m_worker = std::thread(&SnakeSolver::run, this);
+    std::cout << "SnakeSolver::start(): solver thread started." << std::endl;
+}
+
+void SnakeSolver::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+
+    m_worker.join();
+    std::cout << "SnakeSolver::stop(): solver thread stopped after " << m_iteration << " iterations." << std::endl;
+}
+
+bool SnakeSolver::edit(const SnakeEdit& edit) {
+    return m_edits.push(edit);
+}
+
+bool SnakeSolver::update() {
+    return m_snapshots.update();
+}
+
+const ContourSnapshot& SnakeSolver::snapshot() const {
+    return m_snapshots.front();
+}
+
+void SnakeSolver::run() {
+    while (m_running.load(std::memory_order_acquire)) {
+        const bool edited = applyEdits();
+        const bool moved = iterate();
+
+        if (edited || moved) {
+            publish();
+        }
+
+        // Converged or empty, nothing to do until the user edits the contour.
+        if (!moved) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+static float distance(const snaxel& a, const snaxel& b) {
+    const float dx = static_cast<float>(a.x) - static_cast<float>(b.x);
+    const float dy = static_cast<float>(a.y) - static_cast<float>(b.y);
+
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Index of the snaxel with the given id, or the snaxel count if it is gone.
+size_t SnakeSolver::find(const uint32_t id) const {
+    return std::find(m_ids.begin(), m_ids.end(), id) - m_ids.begin();
+}
+
+bool SnakeSolver::applyEdits() {
+    const size_t width  = m_edgeMap->width();
+    const size_t height = m_edgeMap->height();
+
+    bool edited = false;
+    SnakeEdit edit;
+
+    while (m_edits.pop(&edit)) {
+        snaxel position = edit.position;
+        position.x = std::min(position.x, width - 1);
+        position.y = std::min(position.y, height - 1);
+
+        const size_t n = m_snaxels.size();
+        const size_t index = find(edit.id);
+
+        switch (edit.type) {
+            case SnakeEdit::Add: {
+                size_t insertAt = n;
+
+                if (n >= 2) {
+                    float bestCost = std::numeric_limits<float>::max();
+
+                    for (size_t i = 0; i < n; ++i) {
+                        const snaxel& a = m_snaxels[i];
+                        const snaxel& b = m_snaxels[(i + 1) % n];
+                        const float cost = distance(a, position) + distance(position, b) - distance(a, b);
+
+                        if (cost < bestCost) {
+                            bestCost = cost;
+                            insertAt = i + 1;
+                        }
+                    }
+                }
+
+                m_snaxels.insert(m_snaxels.begin() + insertAt, position);
+                m_pinned.insert(m_pinned.begin() + insertAt, false);
+                m_ids.insert(m_ids.begin() + insertAt, m_nextId++);
+                break;
+            }
+            case SnakeEdit::Move:
+                if (index < n) {
+                    m_snaxels[index] = position;
+                    m_pinned[index] = true;
+                }
+                break;
+            case SnakeEdit::Release:
+                if (index < n) {
+                    m_pinned[index] = false;
+                }
+                break;
+            case SnakeEdit::Remove:
+                if (index < n) {
+                    m_snaxels.erase(m_snaxels.begin() + index);
+                    m_pinned.erase(m_pinned.begin() + index);
+                    m_ids.erase(m_ids.begin() + index);
+                }
+                break;
+            case SnakeEdit::Clear:
+                m_snaxels.clear();
+                m_pinned.clear();
+                m_ids.clear();
+                break;
+        }
+
+        edited = true;
+    }
+
+    return edited;
+}
+
+/*
+ * One pass of the greedy algorithm: every free snaxel moves to the point of its neighbourhood with the
+ * lowest weighted sum of continuity, curvature and image energy, each normalized over the neighbourhood.
+ * Returns true if any snaxel moved.
+ */
+bool SnakeSolver::iterate() {
+    const size_t n = m_snaxels.size();
+
+    if (n < 3) {
+        return false;
+    }
+
+    const GrayImage& edgeMap = *m_edgeMap;
+    const GrayImage* distanceMap = m_distanceMap.get();
+    const int width  = static_cast<int>(edgeMap.width());
+    const int height = static_cast<int>(edgeMap.height());
+
+    float meanDistance = 0.0f;
+
+    for (size_t i = 0; i < n; ++i) {
+        meanDistance += distance(m_snaxels[i], m_snaxels[(i + 1) % n]);
+    }
+
+    meanDistance /= n;
+
+    const int window = 2 * kSnakeSearchRadius + 1;
+    const int candidates = window * window;
+
+    float continuity[candidates];
+    float curvature[candidates];
+    float image[candidates];
+    float edgeDistance[candidates];
+    snaxel positions[candidates];
+
+    size_t moved = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        if (m_pinned[i]) {
+            continue;
+        }
+
+        const snaxel& prev = m_snaxels[(i + n - 1) % n];
+        const snaxel& next = m_snaxels[(i + 1) % n];
+        const snaxel current = m_snaxels[i];
+
+        float maxContinuity = 0.0f;
+        float maxCurvature  = 0.0f;
+        float minImage      = std::numeric_limits<float>::max();
+        float maxImage      = -std::numeric_limits<float>::max();
+        float minDistance   = std::numeric_limits<float>::max();
+        float maxDistance   = 0.0f;
+
+        int count = 0;
+
+        for (int dy = -kSnakeSearchRadius; dy <= kSnakeSearchRadius; ++dy) {
+            for (int dx = -kSnakeSearchRadius; dx <= kSnakeSearchRadius; ++dx) {
+                const int x = static_cast<int>(current.x) + dx;
+                const int y = static_cast<int>(current.y) + dy;
+
+                if (x < 0 || y < 0 || x >= width || y >= height) {
+                    continue;
+                }
+
+                snaxel& p = positions[count];
+                p.x = x;
+                p.y = y;
+
+                const float cx = static_cast<float>(prev.x) - 2.0f * x + static_cast<float>(next.x);
+                const float cy = static_cast<float>(prev.y) - 2.0f * y + static_cast<float>(next.y);
+
+                continuity[count]   = std::fabs(meanDistance - distance(prev, p));
+                curvature[count]    = cx * cx + cy * cy;
+                image[count]        = edgeMap(y, x);
+                edgeDistance[count] = distanceMap ? (*distanceMap)(y, x) : 0.0f;
+
+                maxContinuity   = std::max(maxContinuity, continuity[count]);
+                maxCurvature    = std::max(maxCurvature, curvature[count]);
+                minImage        = std::min(minImage, image[count]);
+                maxImage        = std::max(maxImage, image[count]);
+                minDistance     = std::min(minDistance, edgeDistance[count]);
+                maxDistance     = std::max(maxDistance, edgeDistance[count]);
+
+                ++count;
+            }
+        }
+
+        const float imageRange = maxImage - minImage;
+
+        // Infinite when the image has no edge pixel at all, the term then drops out.
+        const float distanceRange = maxDistance - minDistance;
+        const bool useDistance = distanceRange > 0.0f && !std::isinf(distanceRange);
+
+        float bestEnergy = std::numeric_limits<float>::max();
+        int best = 0;
+
+        for (int k = 0; k < count; ++k) {
+            const float energy =
+                kSnakeAlpha * (maxContinuity > 0.0f ? continuity[k] / maxContinuity : 0.0f) +
+                kSnakeBeta  * (maxCurvature > 0.0f ? curvature[k] / maxCurvature : 0.0f) +
+                kSnakeGamma * (imageRange > 0.0f ? (minImage - image[k]) / imageRange : 0.0f) +
+                kSnakeDelta * (useDistance ? (edgeDistance[k] - minDistance) / distanceRange : 0.0f);
+
+            // Ties keep the snaxel where it is so a converged contour stays put.
+            const bool isCurrent = (positions[k].x == current.x && positions[k].y == current.y);
+
+            if (energy < bestEnergy || (energy == bestEnergy && isCurrent)) {
+                bestEnergy = energy;
+                best = k;
+            }
+        }
+
+        if (positions[best].x != current.x || positions[best].y != current.y) {
+            m_snaxels[i] = positions[best];
+            ++moved;
+        }
+    }
+
+    ++m_iteration;
+
+    return moved > 0;
+}
+
+void SnakeSolver::publish() {
+    ContourSnapshot& snapshot = m_snapshots.back();
+
+    snapshot.snaxels    = m_snaxels;
+    snapshot.ids        = m_ids;
+    snapshot.iteration  = m_iteration;
+    snapshot.published  = std::chrono::steady_clock::now();
+
+    m_snapshots.publish();
+}
@@ -0,0 +1,142 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Snake.hpp
+ *
+ * The following implements a greedy active contour (snake) solver that evolves a
+ * closed contour against an edge map on its own thread. Edits come in through a
+ * lock-free queue and contour snapshots go out through a triple buffer, so the
+ * solver never waits on the GUI and the GUI never waits on the solver.
+ *
+ ****************************************************************************
+ */
+
+#ifndef SNAKE_HPP
+#define SNAKE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Image.hpp"
+#include "LockFree.hpp"
+
+// Weights of the continuity, curvature and image energy terms (Williams & Shah), and of the distance to
+// the nearest edge, which pulls in snaxels that start where the edge map is flat.
+const float  kSnakeAlpha            = 1.0f;
+const float  kSnakeBeta             = 1.0f;
+const float  kSnakeGamma            = 1.2f;
+const float  kSnakeDelta            = 1.0f;
+
+// Each snaxel looks at the (2r + 1) x (2r + 1) neighbourhood around it per iteration.
+const int    kSnakeSearchRadius     = 1;
+
+const size_t kSnakeEditQueueSize    = 256;
+
+// Snaxels are named by id rather than index in edits: indices shift under queued adds and removes.
+const uint32_t kNoSnaxel            = std::numeric_limits<uint32_t>::max();
+
+struct snaxel {
+    size_t x;
+    size_t y;
+};
+
+struct ContourSnapshot {
+    std::vector<snaxel>                     snaxels;
+    std::vector<uint32_t>                   ids;
+    uint64_t                                iteration;
+    std::chrono::steady_clock::time_point   published;
+
+    ContourSnapshot() : iteration(0) { }
+};
+
+struct SnakeEdit {
+    enum Type {
+        Add,        // insert a snaxel at position, on the contour segment it lengthens the least
+        Move,       // move snaxel id to position and pin it there until Release
+        Release,    // let snaxel id evolve again
+        Remove,     // delete snaxel id
+        Clear       // delete every snaxel
+    };
+
+    Type        type;
+    uint32_t    id;
+    snaxel      position;
+};
+
+class SnakeSolver {
+    private:
+        std::shared_ptr<const GrayImage>        m_edgeMap;
+        std::shared_ptr<const GrayImage>        m_distanceMap;
+
+        // Only touched by the worker thread.
+        std::vector<snaxel>                     m_snaxels;
+        std::vector<bool>                       m_pinned;
+        std::vector<uint32_t>                   m_ids;
+        uint32_t                                m_nextId;
+        uint64_t                                m_iteration;
+
+        SpscQueue<SnakeEdit, kSnakeEditQueueSize>   m_edits;
+        TripleBuffer<ContourSnapshot>               m_snapshots;
+
+        std::atomic<bool>                       m_running;
+        std::thread                             m_worker;
+
+        void run();
+        size_t find(const uint32_t id) const;
+        bool applyEdits();
+        bool iterate();
+        void publish();
+
+    public:
+        SnakeSolver(const std::shared_ptr<const GrayImage>& edgeMap,
+                    const std::shared_ptr<const GrayImage>& distanceMap = std::shared_ptr<const GrayImage>());
+        ~SnakeSolver();
+
+        void start();
+        void stop();
+
+        // GUI thread only. Returns false if the edit queue is full.
+        bool edit(const SnakeEdit& edit);
+
+        // GUI thread only. Picks up the latest snapshot, returns true if it is new.
+        bool update();
+        const ContourSnapshot& snapshot() const;
+};
+
+#endif
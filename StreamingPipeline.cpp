@@ -0,0 +1,181 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: StreamingPipeline.cpp
+ *
+ * The following implements an out-of-core version of the edge map pipeline.
+ *
+ ****************************************************************************
+ */
+
+#include "StreamingPipeline.hpp"
+#include "ImageProcessing.hpp"
+#include "ScanlineReader.hpp"
+#include "TiledImage.hpp"
+#include "Timer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <sys/resource.h>
+
+size_t peakResidentBytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+#ifdef __APPLE__
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss * 1024;
+#endif
+}
+
+/*
+ * Edge magnitude of one row from the three gray rows around it, already mapped through the border mode. It
+ * runs the same row correlation as computeEdgeMap(), so a streamed edge map matches the in-memory one.
+ */
+static void edgeMapRow(const float* const* rows, const size_t width, float* padded, float* gx, float* gy, float* out) {
+    correlateRow(rows, width, sobelX(), kEdgeMapBorder, padded, gx);
+    correlateRow(rows, width, sobelY(), kEdgeMapBorder, padded, gy);
+
+    for (size_t j = 0; j < width; ++j) {
+        out[j] = std::sqrt(gx[j] * gx[j] + gy[j] * gy[j]);
+    }
+}
+
+bool streamEdgeMap(const std::string& inputPath, const std::string& outputPath, const size_t stripRows) {
+    Timer timer;
+    timer.tick();
+
+    std::unique_ptr<ScanlineReader> reader(openScanlineReader(inputPath));
+
+    if (!reader) {
+        return false;
+    }
+
+    const size_t width  = reader->width();
+    const size_t height = reader->height();
+    const size_t halo   = 2;    // rows carried over between strips for the 3 x 3 Sobel kernels
+
+    std::cout << "streamEdgeMap(): " << inputPath << ": " << width << " x " << height << ", strips of " << stripRows << " rows." << std::endl;
+
+    TiledImageWriter writer;
+
+    if (!writer.open(outputPath, width, height)) {
+        return false;
+    }
+
+    RgbImage    rgb(width, stripRows);
+    GrayImage   gray(width, stripRows + halo);
+    GrayImage   edges(width, stripRows + halo);
+
+    std::vector<float> zeros(width, 0.0f);
+    std::vector<float> padded(width + 2);
+    std::vector<float> gx(width);
+    std::vector<float> gy(width);
+
+    // gray holds image rows [base, base + filled); an edge row is produced once the row below it is in, or
+    // once the whole image is.
+    size_t base     = 0;
+    size_t filled   = 0;
+    size_t nextRow  = 0;
+
+    while (true) {
+        const size_t decoded = reader->readRows(&rgb, stripRows);
+
+        if (decoded == 0) {
+            break;
+        }
+
+        const GrayImage stripGray = rgbToGray(rgb);
+
+        for (size_t i = 0; i < decoded; ++i) {
+            std::copy(stripGray.row(i), stripGray.row(i) + width, gray.row(filled + i));
+        }
+
+        filled += decoded;
+
+        const size_t available = base + filled;
+        size_t produced = 0;
+
+        for (; nextRow < available && (nextRow + 1 < available || available == height); ++nextRow, ++produced) {
+            float* out = edges.row(produced);
+
+            if (kEdgeMapBorder == kBorderSkip && (nextRow == 0 || nextRow + 1 >= height)) {
+                std::fill(out, out + width, 0.0f);
+                continue;
+            }
+
+            const float* rows[3];
+
+            for (int a = 0; a < 3; ++a) {
+                const ptrdiff_t mapped = borderIndex(static_cast<ptrdiff_t>(nextRow) + a - 1, height, kEdgeMapBorder);
+                rows[a] = mapped < 0 ? zeros.data() : gray.row(mapped - base);
+            }
+
+            edgeMapRow(rows, width, padded.data(), gx.data(), gy.data(), out);
+        }
+
+        if (!writer.writeRows(edges, produced)) {
+            return false;
+        }
+
+        // Slide the halo rows to the top for the next strip.
+        const size_t keep = std::min(filled, halo);
+
+        for (size_t i = 0; i < keep; ++i) {
+            std::copy(gray.row(filled - keep + i), gray.row(filled - keep + i) + width, gray.row(i));
+        }
+
+        base += filled - keep;
+        filled = keep;
+    }
+
+    if (reader->failed() || reader->row() < height) {
+        std::cout << "streamEdgeMap(): decoding stopped at row " << reader->row() << " of " << height << "." << std::endl;
+        return false;
+    }
+
+    if (!writer.close()) {
+        return false;
+    }
+
+    std::cout << "streamEdgeMap(): wrote " << outputPath << " in " << timer.tock() << " ms, peak resident memory "
+              << peakResidentBytes() / (1024 * 1024) << " MB." << std::endl;
+
+    return true;
+}
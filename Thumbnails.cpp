@@ -0,0 +1,481 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Thumbnails.cpp
+ *
+ * The following implements headless thumbnails, the thumbnail cache and contact
+ * sheets.
+ *
+ ****************************************************************************
+ */
+
+#include "Thumbnails.hpp"
+#include "FileStamp.hpp"
+#include "ImageProcessing.hpp"
+#include "ImageStats.hpp"
+#include "Parallel.hpp"
+#include "ScanlineReader.hpp"
+#include "Timer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#include <dirent.h>
+#include <png.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const uint32_t kThumbnailMagic      = 0x42485448;   // "HTHB"
+const uint32_t kThumbnailVersion    = 1;
+
+// Rows decoded per readRows() call while thumbnailing.
+const size_t kThumbnailStripRows    = 64;
+
+/*
+ * Averages the source pixels under each destination pixel. Every destination pixel covers at least one
+ * source pixel, so this is only used for shrinking.
+ */
+static RgbImage areaResample(const RgbImage& source, const size_t width, const size_t height) {
+    RgbImage destination(width, height);
+
+    for (size_t y = 0; y < height; ++y) {
+        const size_t rowBegin   = y * source.height() / height;
+        const size_t rowEnd     = std::max(rowBegin + 1, (y + 1) * source.height() / height);
+
+        for (size_t x = 0; x < width; ++x) {
+            const size_t colBegin   = x * source.width() / width;
+            const size_t colEnd     = std::max(colBegin + 1, (x + 1) * source.width() / width);
+            const uint32_t count    = (rowEnd - rowBegin) * (colEnd - colBegin);
+
+            uint32_t sums[3] = { 0, 0, 0 };
+
+            for (size_t i = rowBegin; i < rowEnd; ++i) {
+                const uint8_t* src = source.row(i);
+
+                for (size_t j = colBegin; j < colEnd; ++j) {
+                    for (size_t c = 0; c < 3; ++c) {
+                        sums[c] += src[j * 3 + c];
+                    }
+                }
+            }
+
+            for (size_t c = 0; c < 3; ++c) {
+                destination(y, x, c) = static_cast<uint8_t>((sums[c] + count / 2) / count);
+            }
+        }
+    }
+
+    return destination;
+}
+
+/*
+ * Edge map of the thumbnail, windowed with the 1-99 percentile preset the viewer offers.
+ */
+static RgbImage edgePreview(const RgbImage& image) {
+    const GrayImage edges = computeEdgeMap(rgbToGray(image));
+
+    std::vector<uint16_t> keys;
+    const ImageStats stats = computeImageStats(edges, &keys);
+    const std::vector<uint8_t> pixels = applyDisplayLut(keys, buildDisplayLut(percentileWindow(stats, 1.0f, 99.0f)), kBytesPerPixel);
+
+    RgbImage preview(image.width(), image.height());
+
+    for (size_t i = 0; i < image.height(); ++i) {
+        std::copy(pixels.begin() + i * image.width() * kBytesPerPixel, pixels.begin() + (i + 1) * image.width() * kBytesPerPixel,
+                  preview.row(i));
+    }
+
+    return preview;
+}
+
+bool makeThumbnail(const std::string& path, const size_t size, Thumbnail* thumbnail) {
+    ImageHeader header;
+
+    if (!readImageHeader(path, &header)) {
+        std::cout << "makeThumbnail(): " << path << " is not a JPEG or PNG." << std::endl;
+        return false;
+    }
+
+    const size_t longSide = std::max(header.width, header.height);
+
+    size_t denominator = 8;
+    while (denominator > 1 && longSide / denominator < size) {
+        denominator /= 2;
+    }
+
+    // An interlaced PNG streams only at 1/8, from its first pass. Below that it is small enough, under 8 x size
+    // on its long side, to decode whole.
+    std::unique_ptr<ScanlineReader> reader(openScanlineReader(path, denominator, header.interlaced));
+
+    if (!reader) {
+        return false;
+    }
+
+    thumbnail->sourceWidth  = reader->fullWidth();
+    thumbnail->sourceHeight = reader->fullHeight();
+
+    RgbImage decoded(reader->width(), reader->height());
+    RgbImage strip(reader->width(), kThumbnailStripRows);
+
+    for (size_t row = 0; row < decoded.height(); ) {
+        const size_t count = reader->readRows(&strip, std::min(kThumbnailStripRows, decoded.height() - row));
+
+        if (count == 0) {
+            std::cout << "makeThumbnail(): " << path << ": decoding stopped at row " << row << "." << std::endl;
+            return false;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            std::copy(strip.row(i), strip.row(i) + decoded.width() * kBytesPerPixel, decoded.row(row + i));
+        }
+
+        row += count;
+    }
+
+    const size_t decodedLongSide = std::max(decoded.width(), decoded.height());
+
+    if (decodedLongSide > size) {
+        const size_t width  = std::max<size_t>(1, (decoded.width() * size + decodedLongSide / 2) / decodedLongSide);
+        const size_t height = std::max<size_t>(1, (decoded.height() * size + decodedLongSide / 2) / decodedLongSide);
+
+        thumbnail->image = areaResample(decoded, width, height);
+    }
+    else {
+        thumbnail->image = decoded;
+    }
+
+    thumbnail->edges = edgePreview(thumbnail->image);
+
+    return true;
+}
+
+ThumbnailCache::ThumbnailCache(const std::string& directory) : m_directory(directory) {
+    if (m_directory.empty()) {
+        return;
+    }
+
+    // mkdir -p
+    for (size_t slash = m_directory.find('/', 1); ; slash = m_directory.find('/', slash + 1)) {
+        mkdir(m_directory.substr(0, slash).c_str(), 0755);
+
+        if (slash == std::string::npos) {
+            break;
+        }
+    }
+}
+
+std::string ThumbnailCache::defaultDirectory() {
+    const char* cacheHome = getenv("XDG_CACHE_HOME");
+
+    if (cacheHome && *cacheHome) {
+        return std::string(cacheHome) + "/ImageViewer/thumbnails";
+    }
+
+    const char* home = getenv("HOME");
+
+    return home ? std::string(home) + "/.cache/ImageViewer/thumbnails" : std::string();
+}
+
+std::string ThumbnailCache::key(const std::string& path, const size_t size) {
+    const std::string stamp = fileStamp(path);
+
+    if (stamp.empty()) {
+        return stamp;
+    }
+
+    std::ostringstream key;
+    key << stamp << '\n' << size;
+
+    return key.str();
+}
+
+// 64 bit FNV-1a of the key names the cache file; the full key inside the file settles collisions.
+std::string ThumbnailCache::entryPath(const std::string& key) const {
+    uint64_t hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < key.size(); ++i) {
+        hash = (hash ^ static_cast<uint8_t>(key[i])) * 1099511628211ull;
+    }
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.thumb", static_cast<unsigned long long>(hash));
+
+    return m_directory + "/" + name;
+}
+
+static bool readPixels(FILE* file, RgbImage* image, const uint32_t width, const uint32_t height) {
+    image->resize(width, height);
+
+    for (size_t i = 0; i < height; ++i) {
+        if (fread(image->row(i), kBytesPerPixel, width, file) != width) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool writePixels(FILE* file, const RgbImage& image) {
+    for (size_t i = 0; i < image.height(); ++i) {
+        if (fwrite(image.row(i), kBytesPerPixel, image.width(), file) != image.width()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Entry layout: magic, version, key length, key, width, height, source width, source height (all uint32),
+ * then the packed RGB rows of the image and of the edge preview.
+ */
+bool ThumbnailCache::load(const std::string& key, const size_t size, Thumbnail* thumbnail) const {
+    if (m_directory.empty() || key.empty()) {
+        return false;
+    }
+
+    FILE* file = fopen(entryPath(key).c_str(), "rb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    uint32_t header[3];
+    bool ok = fread(header, sizeof(uint32_t), 3, file) == 3 && header[0] == kThumbnailMagic && header[1] == kThumbnailVersion &&
+              header[2] == key.size();
+
+    std::string storedKey(ok ? key.size() : 0, '\0');
+    uint32_t sizes[4];
+
+    ok = ok && fread(&storedKey[0], 1, storedKey.size(), file) == storedKey.size() && storedKey == key;
+    ok = ok && fread(sizes, sizeof(uint32_t), 4, file) == 4;
+    ok = ok && sizes[0] > 0 && sizes[1] > 0 && sizes[0] <= size && sizes[1] <= size;
+    ok = ok && readPixels(file, &thumbnail->image, sizes[0], sizes[1]) && readPixels(file, &thumbnail->edges, sizes[0], sizes[1]);
+
+    fclose(file);
+
+    if (ok) {
+        thumbnail->sourceWidth  = sizes[2];
+        thumbnail->sourceHeight = sizes[3];
+    }
+
+    return ok;
+}
+
+// Written to a temporary name and renamed, so a concurrent or interrupted run never sees half an entry.
+bool ThumbnailCache::store(const std::string& key, const Thumbnail& thumbnail) const {
+    if (m_directory.empty() || key.empty()) {
+        return false;
+    }
+
+    const std::string path = entryPath(key);
+
+    std::ostringstream temporary;
+    temporary << path << "." << getpid() << ".tmp";
+
+    FILE* file = fopen(temporary.str().c_str(), "wb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    const uint32_t header[3] = { kThumbnailMagic, kThumbnailVersion, static_cast<uint32_t>(key.size()) };
+    const uint32_t sizes[4]  = { static_cast<uint32_t>(thumbnail.image.width()), static_cast<uint32_t>(thumbnail.image.height()),
+                                 static_cast<uint32_t>(thumbnail.sourceWidth), static_cast<uint32_t>(thumbnail.sourceHeight) };
+
+    bool ok = fwrite(header, sizeof(uint32_t), 3, file) == 3 && fwrite(key.data(), 1, key.size(), file) == key.size() &&
+              fwrite(sizes, sizeof(uint32_t), 4, file) == 4 && writePixels(file, thumbnail.image) && writePixels(file, thumbnail.edges);
+
+    ok = (fclose(file) == 0) && ok;
+    ok = ok && rename(temporary.str().c_str(), path.c_str()) == 0;
+
+    if (!ok) {
+        remove(temporary.str().c_str());
+    }
+
+    return ok;
+}
+
+static bool hasImageExtension(const std::string& name) {
+    const size_t dot = name.find_last_of('.');
+
+    if (dot == std::string::npos) {
+        return false;
+    }
+
+    std::string extension = name.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    return extension == "jpg" || extension == "jpeg" || extension == "png";
+}
+
+std::vector<std::string> listImages(const std::string& folder) {
+    std::vector<std::string> paths;
+
+    DIR* directory = opendir(folder.c_str());
+
+    if (directory == NULL) {
+        std::cout << "listImages(): cannot open " << folder << "." << std::endl;
+        return paths;
+    }
+
+    while (struct dirent* entry = readdir(directory)) {
+        const std::string name = entry->d_name;
+
+        if (name[0] != '.' && hasImageExtension(name)) {
+            paths.push_back(folder + "/" + name);
+        }
+    }
+
+    closedir(directory);
+
+    std::sort(paths.begin(), paths.end());
+
+    return paths;
+}
+
+static bool writePng(const std::string& path, const RgbImage& image) {
+    FILE* file = fopen(path.c_str(), "wb");
+
+    if (file == NULL) {
+        std::cout << "writePng(): cannot create " << path << "." << std::endl;
+        return false;
+    }
+
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png ? png_create_info_struct(png) : NULL;
+
+    if (png == NULL || info == NULL || setjmp(png_jmpbuf(png))) {
+        png_destroy_write_struct(&png, info ? &info : NULL);
+        fclose(file);
+        return false;
+    }
+
+    png_init_io(png, file);
+    png_set_IHDR(png, info, image.width(), image.height(), 8, PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT,
+                 PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+
+    for (size_t i = 0; i < image.height(); ++i) {
+        png_write_row(png, const_cast<png_bytep>(image.row(i)));
+    }
+
+    png_write_end(png, NULL);
+    png_destroy_write_struct(&png, &info);
+
+    return fclose(file) == 0;
+}
+
+static void blit(const RgbImage& source, RgbImage* destination, const size_t top, const size_t left) {
+    for (size_t i = 0; i < source.height(); ++i) {
+        std::copy(source.row(i), source.row(i) + source.width() * kBytesPerPixel, destination->row(top + i) + left * kBytesPerPixel);
+    }
+}
+
+bool writeContactSheet(const std::string& folder, const std::string& sheetPath, const size_t size, const std::string& cacheDirectory) {
+    Timer timer;
+    timer.tick();
+
+    const std::vector<std::string> paths = listImages(folder);
+
+    if (paths.empty()) {
+        std::cout << "writeContactSheet(): no JPEG or PNG images in " << folder << "." << std::endl;
+        return false;
+    }
+
+    const ThumbnailCache cache(cacheDirectory);
+
+    std::vector<Thumbnail> thumbnails(paths.size());
+    std::vector<char> valid(paths.size(), 0);
+
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> hits(0);
+
+    // One chunk per thread, each pulling files off a shared counter so a few large images do not serialize.
+    parallelFor(0, parallelChunkCount(paths.size()), [&](const size_t, const size_t, const size_t) {
+        for (size_t k = next++; k < paths.size(); k = next++) {
+            const std::string key = ThumbnailCache::key(paths[k], size);
+
+            if (cache.load(key, size, &thumbnails[k])) {
+                ++hits;
+                valid[k] = 1;
+            }
+            else if (makeThumbnail(paths[k], size, &thumbnails[k])) {
+                cache.store(key, thumbnails[k]);
+                valid[k] = 1;
+            }
+        }
+    });
+
+    const size_t columns    = std::min(kContactSheetColumns, paths.size());
+    const size_t rows       = (paths.size() + columns - 1) / columns;
+    const size_t cellWidth  = 2 * size + kContactSheetGap;
+    const size_t cellHeight = size;
+
+    RgbImage sheet(columns * cellWidth + (columns + 1) * kContactSheetGap, rows * cellHeight + (rows + 1) * kContactSheetGap);
+
+    for (size_t k = 0; k < paths.size(); ++k) {
+        if (!valid[k]) {
+            continue;
+        }
+
+        const Thumbnail& thumbnail = thumbnails[k];
+
+        // Centred in its half of the cell.
+        const size_t top    = kContactSheetGap + (k / columns) * (cellHeight + kContactSheetGap) + (size - thumbnail.image.height()) / 2;
+        const size_t left   = kContactSheetGap + (k % columns) * (cellWidth + kContactSheetGap) + (size - thumbnail.image.width()) / 2;
+
+        blit(thumbnail.image, &sheet, top, left);
+        blit(thumbnail.edges, &sheet, top, left + size + kContactSheetGap);
+    }
+
+    if (!writePng(sheetPath, sheet)) {
+        return false;
+    }
+
+    const size_t thumbnailed = std::count(valid.begin(), valid.end(), 1);
+
+    std::cout << "writeContactSheet(): " << thumbnailed << " of " << paths.size() << " images (" << hits << " from the cache) to "
+              << sheetPath << " in " << timer.tock() << " ms." << std::endl;
+
+    return true;
+}
@@ -0,0 +1,108 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: Thumbnails.hpp
+ *
+ * The following implements headless thumbnails and contact sheets. Images are
+ * decoded at reduced size (in the DCT domain for JPEGs), resampled to the
+ * thumbnail size, run through the edge map at that size, and kept in a persistent
+ * cache so an unchanged folder costs a file read per image on the next run.
+ *
+ ****************************************************************************
+ */
+
+#ifndef THUMBNAILS_HPP
+#define THUMBNAILS_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Image.hpp"
+
+const size_t kDefaultThumbnailSize  = 256;
+const size_t kContactSheetColumns   = 4;
+const size_t kContactSheetGap       = 8;
+
+/*
+ * The image and its edge preview, both fitting in size x size with the aspect ratio of the source.
+ */
+struct Thumbnail {
+    RgbImage    image;
+    RgbImage    edges;
+    size_t      sourceWidth;
+    size_t      sourceHeight;
+};
+
+/*
+ * Decodes path at the largest decode-time reduction (1/2 to 1/8) that still covers size, then area
+ * resamples to fit. Images smaller than size are not enlarged.
+ */
+bool makeThumbnail(const std::string& path, const size_t size, Thumbnail* thumbnail);
+
+/*
+ * Thumbnails on disk, one file per image, keyed on the canonical path, the thumbnail size and the file's
+ * modification time and length; a changed source simply misses. An empty directory disables the cache.
+ */
+class ThumbnailCache {
+    private:
+        std::string m_directory;
+
+        std::string entryPath(const std::string& key) const;
+
+    public:
+        explicit ThumbnailCache(const std::string& directory);
+
+        // $XDG_CACHE_HOME/ImageViewer/thumbnails, or ~/.cache/ImageViewer/thumbnails.
+        static std::string defaultDirectory();
+
+        // The cache key of path at size, empty if the file cannot be stat'ed.
+        static std::string key(const std::string& path, const size_t size);
+
+        // Entries whose stored dimensions are empty or larger than size are treated as corrupt.
+        bool load(const std::string& key, const size_t size, Thumbnail* thumbnail) const;
+        bool store(const std::string& key, const Thumbnail& thumbnail) const;
+};
+
+// The JPEG and PNG files directly in folder, sorted by name.
+std::vector<std::string> listImages(const std::string& folder);
+
+/*
+ * Thumbnails every image in folder, decoding several files in parallel, and writes a PNG contact sheet with
+ * each image next to its edge preview, kContactSheetColumns pairs to a row.
+ */
+bool writeContactSheet(const std::string& folder, const std::string& sheetPath, const size_t size = kDefaultThumbnailSize,
+                       const std::string& cacheDirectory = ThumbnailCache::defaultDirectory());
+
+#endif
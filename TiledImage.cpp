@@ -0,0 +1,353 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: TiledImage.cpp
+ *
+ * The following implements a simple tiled on-disk format for single channel float
+ * images that are too large to hold in memory.
+ *
+ ****************************************************************************
+ */
+
+#include "TiledImage.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include <sys/types.h>
+#include <unistd.h>
+
+static const char kTiledImageMagic[4] = { 'H', 'T', 'I', 'L' };
+
+static bool seek(FILE* file, const uint64_t offset) {
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+}
+
+static uint64_t tileOffset(const TiledImageHeader& header, const size_t tilesX, const size_t tx, const size_t ty) {
+    const uint64_t tileBytes = static_cast<uint64_t>(header.tileSize) * header.tileSize * sizeof(float);
+
+    return sizeof(TiledImageHeader) + (static_cast<uint64_t>(ty) * tilesX + tx) * tileBytes;
+}
+
+bool isTiledImage(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    char magic[4];
+    const bool matches = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, kTiledImageMagic, sizeof(magic)) == 0;
+    fclose(file);
+
+    return matches;
+}
+
+TiledImageWriter::TiledImageWriter() : m_file(NULL), m_bandRows(0), m_row(0) {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+TiledImageWriter::~TiledImageWriter() {
+    if (m_file) {
+        close();
+    }
+}
+
+bool TiledImageWriter::open(const std::string& path, const size_t width, const size_t height, const size_t tileSize) {
+    std::ostringstream temporary;
+    temporary << path << "." << getpid() << ".tmp";
+
+    m_path = path;
+    m_temporaryPath = temporary.str();
+    m_file = fopen(m_temporaryPath.c_str(), "wb");
+
+    if (m_file == NULL) {
+        std::cout << "TiledImageWriter::open(): cannot create " << m_temporaryPath << "." << std::endl;
+        return false;
+    }
+
+    memcpy(m_header.magic, kTiledImageMagic, sizeof(kTiledImageMagic));
+    m_header.version        = kTiledImageVersion;
+    m_header.width          = width;
+    m_header.height         = height;
+    m_header.tileSize       = tileSize;
+    m_header.overviewScale  = std::max<size_t>(1, (std::max(width, height) + kOverviewMaxSize - 1) / kOverviewMaxSize);
+    m_header.overviewWidth  = (width + m_header.overviewScale - 1) / m_header.overviewScale;
+    m_header.overviewHeight = (height + m_header.overviewScale - 1) / m_header.overviewScale;
+    m_header.minValue       = std::numeric_limits<float>::max();
+    m_header.maxValue       = -std::numeric_limits<float>::max();
+
+    const size_t tilesX = (width + tileSize - 1) / tileSize;
+
+    m_band.resize(tilesX * tileSize, tileSize);
+    m_bandRows  = 0;
+    m_row       = 0;
+
+    m_overview.resize(m_header.overviewWidth, m_header.overviewHeight);
+    m_overviewSums.assign(m_header.overviewWidth, 0.0);
+
+    // Placeholder, the real header goes in when the value range and overview are known.
+    return fwrite(&m_header, sizeof(m_header), 1, m_file) == 1;
+}
+
+void TiledImageWriter::accumulateOverview(const float* row, const size_t y) {
+    const size_t scale = m_header.overviewScale;
+
+    for (size_t x = 0; x < m_header.width; ++x) {
+        m_overviewSums[x / scale] += row[x];
+    }
+
+    // Last row of a block of overview rows, write out the averages.
+    if ((y + 1) % scale == 0 || y + 1 == m_header.height) {
+        const size_t blockRows = y % scale + 1;
+        float* overviewRow = m_overview.row(y / scale);
+
+        for (size_t ox = 0; ox < m_header.overviewWidth; ++ox) {
+            const size_t blockCols = std::min(scale, m_header.width - ox * scale);
+
+            overviewRow[ox] = static_cast<float>(m_overviewSums[ox] / (blockRows * blockCols));
+            m_overviewSums[ox] = 0.0;
+        }
+    }
+}
+
+bool TiledImageWriter::writeRows(const GrayImage& strip, const size_t count) {
+    if (m_file == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count && m_row < m_header.height; ++i, ++m_row) {
+        const float* src = strip.row(i);
+
+        for (size_t x = 0; x < m_header.width; ++x) {
+            m_header.minValue = std::min(m_header.minValue, src[x]);
+            m_header.maxValue = std::max(m_header.maxValue, src[x]);
+        }
+
+        std::copy(src, src + m_header.width, m_band.row(m_bandRows));
+        accumulateOverview(src, m_row);
+
+        if (++m_bandRows == m_header.tileSize && !flushBand()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TiledImageWriter::flushBand() {
+    if (m_bandRows == 0) {
+        return true;
+    }
+
+    const size_t tileSize = m_header.tileSize;
+    const size_t tilesX = m_band.width() / tileSize;
+
+    // Rows below the image in the last band are zero.
+    for (size_t i = m_bandRows; i < tileSize; ++i) {
+        std::fill(m_band.row(i), m_band.row(i) + m_band.width(), 0.0f);
+    }
+
+    std::vector<float> tile(tileSize * tileSize);
+
+    for (size_t tx = 0; tx < tilesX; ++tx) {
+        for (size_t i = 0; i < tileSize; ++i) {
+            std::copy(m_band.row(i) + tx * tileSize, m_band.row(i) + (tx + 1) * tileSize, tile.begin() + i * tileSize);
+        }
+
+        if (fwrite(tile.data(), sizeof(float), tile.size(), m_file) != tile.size()) {
+            std::cout << "TiledImageWriter::flushBand(): write failed." << std::endl;
+            return false;
+        }
+    }
+
+    // Padding columns past the image width stay zero since they are never written.
+    m_bandRows = 0;
+
+    return true;
+}
+
+bool TiledImageWriter::close() {
+    if (m_file == NULL) {
+        return false;
+    }
+
+    bool ok = flushBand();
+
+    if (m_row < m_header.height) {
+        std::cout << "TiledImageWriter::close(): only " << m_row << " of " << m_header.height << " rows were written." << std::endl;
+        ok = false;
+    }
+
+    const uint64_t tilesX = (m_header.width + m_header.tileSize - 1) / m_header.tileSize;
+    const uint64_t tilesY = (m_header.height + m_header.tileSize - 1) / m_header.tileSize;
+
+    m_header.overviewOffset = tileOffset(m_header, tilesX, 0, tilesY);
+
+    ok = ok && seek(m_file, m_header.overviewOffset);
+
+    for (size_t i = 0; ok && i < m_header.overviewHeight; ++i) {
+        ok = fwrite(m_overview.row(i), sizeof(float), m_header.overviewWidth, m_file) == m_header.overviewWidth;
+    }
+
+    ok = ok && seek(m_file, 0) && fwrite(&m_header, sizeof(m_header), 1, m_file) == 1;
+    ok = (fclose(m_file) == 0) && ok;
+    ok = ok && rename(m_temporaryPath.c_str(), m_path.c_str()) == 0;
+
+    if (!ok) {
+        remove(m_temporaryPath.c_str());
+    }
+
+    m_file = NULL;
+    m_band.clear();
+    m_overview.clear();
+
+    return ok;
+}
+
+TiledImageReader::TiledImageReader() : m_file(NULL), m_tilesX(0), m_tilesY(0) {
+    memset(&m_header, 0, sizeof(m_header));
+}
+
+TiledImageReader::~TiledImageReader() {
+    if (m_file) {
+        fclose(m_file);
+    }
+}
+
+bool TiledImageReader::open(const std::string& path) {
+    m_file = fopen(path.c_str(), "rb");
+
+    if (m_file == NULL) {
+        std::cout << "TiledImageReader::open(): cannot open " << path << "." << std::endl;
+        return false;
+    }
+
+    if (fread(&m_header, sizeof(m_header), 1, m_file) != 1 || memcmp(m_header.magic, kTiledImageMagic, sizeof(kTiledImageMagic)) != 0 ||
+        m_header.version != kTiledImageVersion || m_header.tileSize == 0) {
+        std::cout << "TiledImageReader::open(): " << path << " is not a tiled image." << std::endl;
+        return false;
+    }
+
+    m_tilesX = (m_header.width + m_header.tileSize - 1) / m_header.tileSize;
+    m_tilesY = (m_header.height + m_header.tileSize - 1) / m_header.tileSize;
+
+    return true;
+}
+
+const float* TiledImageReader::tile(const size_t tx, const size_t ty) {
+    const size_t key = ty * m_tilesX + tx;
+
+    std::map<size_t, std::list<std::pair<size_t, std::vector<float> > >::iterator>::iterator cached = m_cacheIndex.find(key);
+
+    if (cached != m_cacheIndex.end()) {
+        m_cache.splice(m_cache.begin(), m_cache, cached->second);
+        return m_cache.front().second.data();
+    }
+
+    // Reuse the least recently used tile's buffer once the cache is full.
+    std::vector<float> values;
+
+    if (m_cache.size() >= kTileCacheSize) {
+        m_cacheIndex.erase(m_cache.back().first);
+        values.swap(m_cache.back().second);
+        m_cache.pop_back();
+    }
+
+    values.resize(static_cast<size_t>(m_header.tileSize) * m_header.tileSize);
+
+    if (!seek(m_file, tileOffset(m_header, m_tilesX, tx, ty)) || fread(values.data(), sizeof(float), values.size(), m_file) != values.size()) {
+        std::cout << "TiledImageReader::tile(): failed to read tile " << tx << ", " << ty << "." << std::endl;
+        std::fill(values.begin(), values.end(), 0.0f);
+    }
+
+    m_cache.push_front(std::make_pair(key, std::vector<float>()));
+    m_cache.front().second.swap(values);
+    m_cacheIndex[key] = m_cache.begin();
+
+    return m_cache.front().second.data();
+}
+
+void TiledImageReader::readRegion(const size_t x, const size_t y, const size_t width, const size_t height, GrayImage* region) {
+    region->resize(width, height);
+
+    const size_t tileSize = m_header.tileSize;
+    const size_t xEnd = std::min<size_t>(x + width, m_header.width);
+    const size_t yEnd = std::min<size_t>(y + height, m_header.height);
+
+    for (size_t ty = y / tileSize; ty * tileSize < yEnd; ++ty) {
+        for (size_t tx = x / tileSize; tx * tileSize < xEnd; ++tx) {
+            const float* values = tile(tx, ty);
+
+            const size_t rowBegin = std::max(y, ty * tileSize);
+            const size_t rowEnd = std::min(yEnd, (ty + 1) * tileSize);
+            const size_t colBegin = std::max(x, tx * tileSize);
+            const size_t colEnd = std::min(xEnd, (tx + 1) * tileSize);
+
+            for (size_t row = rowBegin; row < rowEnd; ++row) {
+                const float* src = values + (row - ty * tileSize) * tileSize + (colBegin - tx * tileSize);
+                std::copy(src, src + (colEnd - colBegin), region->row(row - y) + (colBegin - x));
+            }
+        }
+    }
+}
+
+size_t TiledImageReader::cacheBytes() const {
+    return m_cache.size() * static_cast<size_t>(m_header.tileSize) * m_header.tileSize * sizeof(float);
+}
+
+void TiledImageReader::clearCache() {
+    m_cache.clear();
+    m_cacheIndex.clear();
+}
+
+bool TiledImageReader::readOverview(GrayImage* overview, size_t* scale) {
+    overview->resize(m_header.overviewWidth, m_header.overviewHeight);
+    *scale = m_header.overviewScale;
+
+    if (!seek(m_file, m_header.overviewOffset)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < m_header.overviewHeight; ++i) {
+        if (fread(overview->row(i), sizeof(float), m_header.overviewWidth, m_file) != m_header.overviewWidth) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,151 @@
+/****************************************************************************
+ * HabiSoft, LLC
+ ****************************************************************************
+ * 
+ * (c) [2018] - [present]
+ * All Rights Reserved.
+ * 
+ * Limited License: Under no circumstance is commercial use, reproduction, or
+ * distribution permitted. Use, reproduction, and distribution are permitted
+ * solely for educational purposes.
+ *
+ * Any reproduction or distribution of source code must retain the above
+ * copyright notice and the full text of this license including the Disclaimer,
+ * below. 
+ *
+ * Any reproduction or distribution in binary form must reproduce the above
+ * copyright notice and the full text of this license including the Disclaimer
+ * below in the documentation and/or other materials provided with the Distribution.
+ *
+ * DISCLAIMER
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR 
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY 
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ ****************************************************************************
+ *
+ * file: TiledImage.hpp
+ *
+ * The following implements a simple tiled on-disk format for single channel float
+ * images that are too large to hold in memory. The writer takes rows top to
+ * bottom and only buffers one band of tiles; the reader pages tiles in on demand
+ * through a small LRU cache. A downsampled overview is stored with the tiles.
+ *
+ ****************************************************************************
+ */
+
+#ifndef TILED_IMAGE_HPP
+#define TILED_IMAGE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Image.hpp"
+
+const uint32_t  kTiledImageVersion      = 1;
+const size_t    kDefaultTileSize        = 256;
+const size_t    kOverviewMaxSize        = 2048;
+const size_t    kTileCacheSize          = 64;
+
+struct TiledImageHeader {
+    char        magic[4];
+    uint32_t    version;
+    uint32_t    width;
+    uint32_t    height;
+    uint32_t    tileSize;
+    uint32_t    overviewWidth;
+    uint32_t    overviewHeight;
+    uint32_t    overviewScale;
+    uint64_t    overviewOffset;
+    float       minValue;
+    float       maxValue;
+};
+
+class TiledImageWriter {
+    private:
+        // Written under a temporary name and renamed to the path on a successful close, so a failed or
+        // interrupted run never leaves a truncated file behind.
+        FILE*                   m_file;
+        std::string             m_path;
+        std::string             m_temporaryPath;
+        TiledImageHeader        m_header;
+
+        // One band of tiles, tileSize rows of the full (tile padded) width.
+        GrayImage               m_band;
+        size_t                  m_bandRows;
+        size_t                  m_row;
+
+        GrayImage               m_overview;
+        std::vector<double>     m_overviewSums;
+
+        bool flushBand();
+        void accumulateOverview(const float* row, const size_t y);
+
+    public:
+        TiledImageWriter();
+        ~TiledImageWriter();
+
+        bool open(const std::string& path, const size_t width, const size_t height, const size_t tileSize = kDefaultTileSize);
+
+        // Appends rows [0, count) of strip below the rows written so far.
+        bool writeRows(const GrayImage& strip, const size_t count);
+
+        // Flushes the last band, writes the overview and the final header and moves the file into place. On
+        // failure, or if fewer rows than the height were written, the partial file is removed.
+        bool close();
+};
+
+class TiledImageReader {
+    private:
+        FILE*                   m_file;
+        TiledImageHeader        m_header;
+        size_t                  m_tilesX;
+        size_t                  m_tilesY;
+
+        // Most recently used tile first.
+        std::list<std::pair<size_t, std::vector<float> > >                                     m_cache;
+        std::map<size_t, std::list<std::pair<size_t, std::vector<float> > >::iterator>         m_cacheIndex;
+
+    public:
+        TiledImageReader();
+        ~TiledImageReader();
+
+        bool open(const std::string& path);
+
+        size_t  width() const       { return m_header.width; }
+        size_t  height() const      { return m_header.height; }
+        size_t  tileSize() const    { return m_header.tileSize; }
+        float   minValue() const    { return m_header.minValue; }
+        float   maxValue() const    { return m_header.maxValue; }
+        size_t  overviewScale() const   { return m_header.overviewScale; }
+
+        // Returns tileSize x tileSize values of tile (tx, ty), reading it from disk if it is not cached.
+        // The pointer stays valid until the next call.
+        const float* tile(const size_t tx, const size_t ty);
+
+        // Copies a full resolution region, paging in whatever tiles it touches.
+        void readRegion(const size_t x, const size_t y, const size_t width, const size_t height, GrayImage* region);
+
+        // Reads the stored overview; scale is how many full resolution pixels one overview pixel covers.
+        bool readOverview(GrayImage* overview, size_t* scale);
+
+        // Bytes held by cached tiles, and dropping them.
+        size_t  cacheBytes() const;
+        void    clearCache();
+};
+
+bool isTiledImage(const std::string& path);
+
+#endif